@@ -0,0 +1,159 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  block_pca.cpp
+ *
+ *    Description:  Learned per-block projection of HOG descriptors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "block_pca.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+const char *kProjectionHeader = "# videotrainer block pca v1";
+
+}
+
+void ComputeBlockGrid(const cv::HOGDescriptor &hog, const cv::Mat &image, BlockGrid &grid) {
+  cv::HOGDescriptor block_hog(hog.blockSize, hog.blockSize, hog.blockStride, hog.cellSize, hog.nbins);
+  grid.block_values=(int)block_hog.getDescriptorSize();
+  grid.blocks_x=(image.cols>=hog.blockSize.width ? (image.cols-hog.blockSize.width)/hog.blockStride.width+1 : 0);
+  grid.blocks_y=(image.rows>=hog.blockSize.height ? (image.rows-hog.blockSize.height)/hog.blockStride.height+1 : 0);
+  grid.values.clear();
+  if(grid.blocks_x==0 || grid.blocks_y==0) return;
+  block_hog.compute(image, grid.values, hog.blockStride, cv::Size(0, 0));
+  if(grid.values.size()<(size_t)grid.blocks_x*grid.blocks_y*grid.block_values) grid.blocks_x=grid.blocks_y=0;
+}
+
+bool FitBlockProjection(const FeatureMatrix &data, int block_values, int components, int max_samples,
+                        BlockProjection &projection, std::vector<double> *explained) {
+  if(block_values<=0 || data.cols%block_values || components<=0 || components>block_values || data.rows==0) return false;
+  const int blocks=data.cols/block_values;
+  const long long available=(long long)data.rows*blocks;
+  const long long wanted=(max_samples>0 ? std::min<long long>(max_samples, available) : available);
+
+  cv::Mat samples((int)wanted, block_values, CV_32F);
+  std::vector<float> scratch(data.cols);
+  for(long long s=0; s<wanted; s++) {
+    const long long pick=s*available/wanted;
+    const float *row=data.row((int)(pick/blocks), scratch.data());
+    std::copy(row+(pick%blocks)*block_values, row+(pick%blocks+1)*block_values, samples.ptr<float>((int)s));
+  }
+
+  // All components are computed (the matrix is block_values wide) so the
+  // explained shares are exact; the first `components` are kept.
+  cv::PCA pca(samples, cv::Mat(), cv::PCA::DATA_AS_ROW, block_values);
+  projection.block_values=block_values;
+  projection.components=components;
+  projection.mean.assign(pca.mean.ptr<float>(), pca.mean.ptr<float>()+block_values);
+  projection.basis.resize((size_t)components*block_values);
+  for(int c=0; c<components; c++) {
+    const float *vector=pca.eigenvectors.ptr<float>(c);
+    std::copy(vector, vector+block_values, projection.basis.begin()+(size_t)c*block_values);
+  }
+  if(explained) {
+    const int count=(int)pca.eigenvalues.total();
+    double total=0.0;
+    for(int c=0; c<count; c++) total+=pca.eigenvalues.at<float>(c);
+    explained->clear();
+    double kept=0.0;
+    for(int c=0; c<count; c++) {
+      kept+=pca.eigenvalues.at<float>(c);
+      explained->push_back(total>0 ? kept/total : 1.0);
+    }
+  }
+  return true;
+}
+
+void ProjectBlocks(const BlockProjection &projection, const float *descriptor, int blocks, float *projected) {
+  const int values=projection.block_values;
+  for(int b=0; b<blocks; b++) {
+    const float *block=descriptor+(size_t)b*values;
+    for(int c=0; c<projection.components; c++) {
+      const float *axis=&projection.basis[(size_t)c*values];
+      float sum=0.f;
+      for(int v=0; v<values; v++) sum+=axis[v]*(block[v]-projection.mean[v]);
+      projected[(size_t)b*projection.components+c]=sum;
+    }
+  }
+}
+
+bool BackProjectDetector(const BlockProjection &projection, const std::vector<float> &projected_detector,
+                         std::vector<float> &detector) {
+  if(projected_detector.empty() || (projected_detector.size()-1)%projection.components) return false;
+  const int blocks=(int)(projected_detector.size()-1)/projection.components;
+  const int values=projection.block_values;
+  detector.assign((size_t)blocks*values+1, 0.f);
+  double bias=projected_detector.back();
+  for(int b=0; b<blocks; b++) {
+    float *weights=&detector[(size_t)b*values];
+    for(int c=0; c<projection.components; c++) {
+      const float coefficient=projected_detector[(size_t)b*projection.components+c];
+      const float *axis=&projection.basis[(size_t)c*values];
+      for(int v=0; v<values; v++) weights[v]+=coefficient*axis[v];
+    }
+    for(int v=0; v<values; v++) bias-=(double)weights[v]*projection.mean[v];
+  }
+  detector.back()=(float)bias;
+  return true;
+}
+
+bool SaveBlockProjection(const std::string &projection_file, const BlockProjection &projection) {
+  std::ofstream output(projection_file.c_str(), std::ios::out|std::ios::trunc);
+  if(!output) return false;
+  output.precision(9);
+  output << kProjectionHeader << "\n";
+  output << "block_values " << projection.block_values << "\n";
+  output << "components " << projection.components << "\n";
+  output << "mean";
+  for(int v=0; v<projection.block_values; v++) output << " " << projection.mean[v];
+  output << "\n";
+  for(int c=0; c<projection.components; c++) {
+    output << "axis";
+    for(int v=0; v<projection.block_values; v++) output << " " << projection.basis[(size_t)c*projection.block_values+v];
+    output << "\n";
+  }
+  return (bool)output;
+}
+
+bool LoadBlockProjection(const std::string &projection_file, BlockProjection &projection) {
+  std::ifstream input(projection_file.c_str());
+  std::string line;
+  if(!std::getline(input, line) || line!=kProjectionHeader) return false;
+
+  projection.block_values=projection.components=0;
+  projection.mean.clear();
+  projection.basis.clear();
+  while(std::getline(input, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    fields >> key;
+    if(key=="block_values") fields >> projection.block_values;
+    else if(key=="components") fields >> projection.components;
+    else if(key=="mean" || key=="axis") {
+      std::vector<float> &target=(key=="mean" ? projection.mean : projection.basis);
+      for(int v=0; v<projection.block_values; v++) {
+        float value;
+        fields >> value;
+        target.push_back(value);
+      }
+    } else continue;
+    if(!fields) return false;
+  }
+  return projection.block_values>0 && projection.components>0
+      && (int)projection.mean.size()==projection.block_values
+      && projection.basis.size()==(size_t)projection.components*projection.block_values;
+}
@@ -0,0 +1,74 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  block_pca.h
+ *
+ *    Description:  Learned per-block projection of HOG descriptors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_BLOCK_PCA_H_
+#define VIDEOTRAINER_BLOCK_PCA_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "feature_file.h"
+
+// Histograms of every block position of an image, as HOGDescriptor
+// normalises them, row-major over the block grid. Windows on the block
+// stride read their blocks from here instead of recomputing them.
+struct BlockGrid {
+  int blocks_x;
+  int blocks_y;
+  int block_values;
+  std::vector<float> values;
+
+  const float *block(int x, int y) const { return &values[((size_t)y*blocks_x+x)*block_values]; }
+};
+
+// `image` goes to HOG as given, gray or BGR, so the blocks match what a
+// window HOG computes on the same frame. Uses a HOG whose window is one
+// block, whose descriptors are exactly the block values inside any larger
+// window.
+void ComputeBlockGrid(const cv::HOGDescriptor &hog, const cv::Mat &image, BlockGrid &grid);
+
+// One PCA basis shared by every block of a descriptor: each block's values
+// become `components` coordinates, so a descriptor shrinks by
+// block_values/components while keeping the block layout.
+struct BlockProjection {
+  int block_values;
+  int components;
+  std::vector<float> mean;   // block_values
+  std::vector<float> basis;  // components rows of block_values
+};
+
+// Fits on up to `max_samples` block vectors spread evenly over the rows.
+// `explained`, if given, receives the share of block variance kept by the
+// first 1, 2, ... block_values components.
+bool FitBlockProjection(const FeatureMatrix &data, int block_values, int components, int max_samples,
+                        BlockProjection &projection, std::vector<double> *explained=0);
+
+// Projects each of `blocks` consecutive blocks of `descriptor`.
+void ProjectBlocks(const BlockProjection &projection, const float *descriptor, int blocks, float *projected);
+
+// Turns a detector trained on projected rows into the equivalent detector
+// over full descriptors, for cv::HOGDescriptor and the other tools:
+// w_b = basis^T v_b and the bias absorbs -sum w_b.mean.
+bool BackProjectDetector(const BlockProjection &projection, const std::vector<float> &projected_detector,
+                         std::vector<float> &detector);
+
+bool SaveBlockProjection(const std::string &projection_file, const BlockProjection &projection);
+bool LoadBlockProjection(const std::string &projection_file, BlockProjection &projection);
+
+#endif
@@ -0,0 +1,161 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  compact_detector.cpp
+ *
+ *    Description:  Sliding-window detection on FHOG and block-PCA descriptors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "compact_detector.h"
+
+#include <cmath>
+
+namespace {
+
+float Dot(const float *a, const float *b, int count) {
+  float sum=0.f;
+  for(int i=0; i<count; i++) sum+=a[i]*b[i];
+  return sum;
+}
+
+class CompactLevel : public cv::ParallelLoopBody {
+ public:
+  CompactLevel(const CompactDetector &detector, const cv::Mat &image, const std::vector<double> &scales,
+               std::vector< std::vector<ScoredDetection> > &found)
+    : detector_(detector), image_(image), scales_(scales), found_(found) {}
+
+  void operator()(const cv::Range &range) const {
+    for(int level=range.start; level<range.end; level++) {
+      cv::Mat resized;
+      if(scales_[level]==1.0) resized=image_;
+      else cv::resize(image_, resized, cv::Size((int)std::round(image_.cols/scales_[level]), (int)std::round(image_.rows/scales_[level])));
+      if(detector_.mode==kFhogDescriptor) ScanFhog(resized, scales_[level], found_[level]);
+      else ScanPca(resized, scales_[level], found_[level]);
+    }
+  }
+
+ private:
+  void Add(int x, int y, double scale, float score, std::vector<ScoredDetection> &found) const {
+    ScoredDetection detection;
+    detection.box=cv::Rect((int)std::round(x*scale), (int)std::round(y*scale),
+                           (int)std::round(detector_.hog.winSize.width*scale),
+                           (int)std::round(detector_.hog.winSize.height*scale));
+    detection.score=score;
+    found.push_back(detection);
+  }
+
+  void ScanFhog(const cv::Mat &image, double scale, std::vector<ScoredDetection> &found) const {
+    FhogMap map;
+    ComputeFhogMap(image, detector_.cell_size, map);
+    const int cell=detector_.cell_size;
+    const int window_x=detector_.hog.winSize.width/cell-2;
+    const int window_y=detector_.hog.winSize.height/cell-2;
+    const int row_values=window_x*kFhogCellValues;
+    const float *weights=&detector_.detector[0];
+    const float bias=detector_.detector.back();
+    // A window's descriptor is window_y runs of window_x cells, each run
+    // contiguous in the map.
+    for(int y=0; y+window_y<=map.cells_y; y++) {
+      for(int x=0; x+window_x<=map.cells_x; x++) {
+        float score=bias;
+        for(int r=0; r<window_y; r++) score+=Dot(weights+(size_t)r*row_values, map.cell(x, y+r), row_values);
+        if(score>0) Add(x*cell, y*cell, scale, score, found);
+      }
+    }
+  }
+
+  void ScanPca(const cv::Mat &image, double scale, std::vector<ScoredDetection> &found) const {
+    const cv::HOGDescriptor &hog=detector_.hog;
+    BlockGrid grid;
+    ComputeBlockGrid(hog, image, grid);
+    const BlockProjection &projection=detector_.projection;
+    if(grid.blocks_x==0 || grid.block_values!=projection.block_values) return;
+
+    // Every block position is projected once and shared by all the windows
+    // that cover it.
+    const int k=projection.components;
+    const int positions=grid.blocks_x*grid.blocks_y;
+    std::vector<float> projected((size_t)positions*k);
+    ProjectBlocks(projection, &grid.values[0], positions, &projected[0]);
+
+    const int blocks_x=(hog.winSize.width-hog.blockSize.width)/hog.blockStride.width+1;
+    const int blocks_y=(hog.winSize.height-hog.blockSize.height)/hog.blockStride.height+1;
+    const float *weights=&detector_.detector[0];
+    const float bias=detector_.detector.back();
+    for(int wy=0; wy+blocks_y<=grid.blocks_y; wy++) {
+      for(int wx=0; wx+blocks_x<=grid.blocks_x; wx++) {
+        float score=bias;
+        for(int bx=0; bx<blocks_x; bx++) {
+          for(int by=0; by<blocks_y; by++) {
+            score+=Dot(weights+(size_t)(bx*blocks_y+by)*k, &projected[((size_t)(wy+by)*grid.blocks_x+wx+bx)*k], k);
+          }
+        }
+        if(score>0) Add(wx*hog.blockStride.width, wy*hog.blockStride.height, scale, score, found);
+      }
+    }
+  }
+
+  const CompactDetector &detector_;
+  const cv::Mat &image_;
+  const std::vector<double> &scales_;
+  std::vector< std::vector<ScoredDetection> > &found_;
+};
+
+}
+
+bool ParseDescriptorMode(const std::string &name, DescriptorMode &mode) {
+  if(name=="hog") mode=kHogDescriptor;
+  else if(name=="fhog") mode=kFhogDescriptor;
+  else if(name=="pca") mode=kPcaDescriptor;
+  else return false;
+  return true;
+}
+
+const char *DescriptorModeName(DescriptorMode mode) {
+  switch(mode) {
+    case kHogDescriptor: return "hog";
+    case kFhogDescriptor: return "fhog";
+    case kPcaDescriptor: return "pca";
+  }
+  return "unknown";
+}
+
+int CompactDetector::descriptor_size() const {
+  switch(mode) {
+    case kHogDescriptor: return (int)hog.getDescriptorSize();
+    case kFhogDescriptor: return FhogDescriptorSize(hog.winSize, cell_size);
+    case kPcaDescriptor: return (int)hog.getDescriptorSize()/projection.block_values*projection.components;
+  }
+  return 0;
+}
+
+void DetectCompactMultiScale(const CompactDetector &detector, const cv::Mat &image, double scale_step,
+                             std::vector<ScoredDetection> &detections) {
+  detections.clear();
+  // FHOG works on intensity, as in training. PCA blocks come from HOG on
+  // the frame as given, which on BGR takes the strongest gradient across
+  // the channels, the same as the blocks svmtrain projected.
+  cv::Mat input=image;
+  if(detector.mode==kFhogDescriptor && image.channels()!=1) cv::cvtColor(image, input, cv::COLOR_BGR2GRAY);
+
+  std::vector<double> scales;
+  for(double scale=1.0; input.cols/scale>=detector.hog.winSize.width && input.rows/scale>=detector.hog.winSize.height; scale*=scale_step) {
+    scales.push_back(scale);
+    if(scale_step<=1.0) break;
+  }
+
+  std::vector< std::vector<ScoredDetection> > found(scales.size());
+  cv::parallel_for_(cv::Range(0, (int)scales.size()), CompactLevel(detector, input, scales, found));
+  for(size_t level=0; level<found.size(); level++) {
+    detections.insert(detections.end(), found[level].begin(), found[level].end());
+  }
+}
@@ -0,0 +1,58 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  compact_detector.h
+ *
+ *    Description:  Sliding-window detection on FHOG and block-PCA descriptors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_COMPACT_DETECTOR_H_
+#define VIDEOTRAINER_COMPACT_DETECTOR_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "block_pca.h"
+#include "fhog.h"
+#include "nms.h"
+
+enum DescriptorMode {
+  kHogDescriptor,   // cv::HOGDescriptor, 36 values per block position
+  kFhogDescriptor,  // 31 values per interior cell (fhog.h)
+  kPcaDescriptor    // HOG blocks through a learned projection (block_pca.h)
+};
+
+bool ParseDescriptorMode(const std::string &name, DescriptorMode &mode);
+const char *DescriptorModeName(DescriptorMode mode);
+
+// A linear detector over one of the compact descriptors.
+struct CompactDetector {
+  DescriptorMode mode;
+  cv::HOGDescriptor hog;        // window size; block geometry of kPcaDescriptor
+  int cell_size;                // kFhogDescriptor cell in pixels
+  BlockProjection projection;   // kPcaDescriptor
+  std::vector<float> detector;  // weights followed by the bias
+
+  int descriptor_size() const;
+};
+
+// Scans an image pyramid like detectMultiScale with a window stride of one
+// cell (FHOG) or one block stride (PCA). Each level's feature map is built
+// once -- FHOG cells, or HOG blocks projected once each -- and every window
+// is a dot product over the cells or blocks it covers. Detections come
+// back with their scores, unsuppressed.
+void DetectCompactMultiScale(const CompactDetector &detector, const cv::Mat &image, double scale_step,
+                             std::vector<ScoredDetection> &detections);
+
+#endif
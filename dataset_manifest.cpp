@@ -0,0 +1,178 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  dataset_manifest.cpp
+ *
+ *    Description:  Persistent per-video index of a training corpus
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 11시 05분 47초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "dataset_manifest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <opencv2/opencv.hpp>
+#include <boost/filesystem.hpp>
+
+namespace {
+
+const char *kManifestHeader = "# videotrainer manifest v1";
+const std::streamsize kHashChunk = 1<<20;
+const unsigned long long kFnvOffset = 14695981039346656037ULL;
+const unsigned long long kFnvPrime = 1099511628211ULL;
+
+void Fnv1a(const char *data, std::streamsize length, unsigned long long &hash) {
+  for(std::streamsize i=0; i<length; i++) {
+    hash^=(unsigned char)data[i];
+    hash*=kFnvPrime;
+  }
+}
+
+std::string FourccString(int fourcc) {
+  std::string codec;
+  for(int i=0; i<4; i++) {
+    const char c=(char)((fourcc>>(8*i))&0xFF);
+    codec+=(c>' ' && c<0x7F ? c : '?');
+  }
+  return codec;
+}
+
+}
+
+bool LoadManifest(const std::string &manifest_file, std::vector<ManifestEntry> &entries) {
+  std::ifstream manifest(manifest_file.c_str());
+  if(!manifest) return false;
+
+  std::string line;
+  if(!std::getline(manifest, line) || line!=kManifestHeader) {
+    std::cerr << "Error: " << manifest_file << " is not a manifest" << std::endl;
+    return false;
+  }
+  while(std::getline(manifest, line)) {
+    if(line.empty()) continue;
+    std::istringstream fields(line);
+    ManifestEntry entry;
+    fields >> entry.label >> entry.file_size >> entry.modified >> entry.hash
+           >> entry.frame_count >> entry.fps >> entry.width >> entry.height >> entry.codec;
+    fields.get();
+    if(!fields || !std::getline(fields, entry.path) || entry.path.empty()) {
+      std::cerr << "Error: malformed manifest line: " << line << std::endl;
+      return false;
+    }
+    entries.push_back(entry);
+  }
+  return true;
+}
+
+bool SaveManifest(const std::string &manifest_file, const std::vector<ManifestEntry> &entries) {
+  // Written beside the target and renamed over it, so readers never see a
+  // half-written manifest.
+  const std::string temporary_file=manifest_file+".tmp";
+  {
+    std::ofstream manifest(temporary_file.c_str(), std::ios::out|std::ios::trunc);
+    if(!manifest) return false;
+    manifest << kManifestHeader << "\n";
+    for(size_t i=0; i<entries.size(); i++) {
+      const ManifestEntry &entry=entries[i];
+      manifest << entry.label << "\t" << entry.file_size << "\t" << entry.modified << "\t"
+               << entry.hash << "\t" << entry.frame_count << "\t" << entry.fps << "\t"
+               << entry.width << "\t" << entry.height << "\t" << entry.codec << "\t"
+               << entry.path << "\n";
+    }
+    if(!manifest) return false;
+  }
+  return std::rename(temporary_file.c_str(), manifest_file.c_str())==0;
+}
+
+std::string ContentHash(const std::string &path) {
+  std::ifstream file(path.c_str(), std::ios::in|std::ios::binary);
+  if(!file) return std::string();
+
+  file.seekg(0, std::ios::end);
+  const long long file_size=(long long)file.tellg();
+  unsigned long long hash=kFnvOffset;
+  Fnv1a((const char *)&file_size, sizeof(file_size), hash);
+
+  std::vector<char> buffer(kHashChunk);
+  file.seekg(0, std::ios::beg);
+  file.read(&buffer[0], kHashChunk);
+  Fnv1a(&buffer[0], file.gcount(), hash);
+  if(file_size>kHashChunk) {
+    // The last MiB, or just the rest when the chunks would overlap, so every
+    // byte of a file under 2 MiB reaches the hash.
+    const long long tail=std::max<long long>(kHashChunk, file_size-kHashChunk);
+    file.clear();
+    file.seekg(tail, std::ios::beg);
+    file.read(&buffer[0], file_size-tail);
+    Fnv1a(&buffer[0], file.gcount(), hash);
+  }
+
+  char digest[17];
+  std::snprintf(digest, sizeof(digest), "%016llx", hash);
+  return digest;
+}
+
+bool ProbeVideo(const std::string &path, int label, ManifestEntry &entry) {
+  cv::VideoCapture video(path);
+  if(!video.isOpened()) return false;
+
+  boost::system::error_code error;
+  entry.label=label;
+  entry.path=path;
+  entry.file_size=(long long)boost::filesystem::file_size(path, error);
+  if(error) return false;
+  entry.modified=(long long)boost::filesystem::last_write_time(path, error);
+  if(error) return false;
+  entry.hash=ContentHash(path);
+  entry.frame_count=(int)video.get(cv::CAP_PROP_FRAME_COUNT);
+  entry.fps=video.get(cv::CAP_PROP_FPS);
+  entry.width=(int)video.get(cv::CAP_PROP_FRAME_WIDTH);
+  entry.height=(int)video.get(cv::CAP_PROP_FRAME_HEIGHT);
+  entry.codec=FourccString((int)video.get(cv::CAP_PROP_FOURCC));
+  return true;
+}
+
+bool IsUnchanged(const ManifestEntry &entry) {
+  boost::system::error_code error;
+  const long long file_size=(long long)boost::filesystem::file_size(entry.path, error);
+  if(error) return false;
+  const long long modified=(long long)boost::filesystem::last_write_time(entry.path, error);
+  if(error) return false;
+  return file_size==entry.file_size && modified==entry.modified;
+}
+
+void SelectVideos(const std::vector<ManifestEntry> &entries, int label,
+                  std::vector<std::string> &videos, std::vector<int> &frame_counts) {
+  for(size_t i=0; i<entries.size(); i++) {
+    if(entries[i].label!=label) continue;
+    videos.push_back(entries[i].path);
+    frame_counts.push_back(entries[i].frame_count);
+  }
+}
+
+std::string ExtractedIndexPath(const std::string &feature_file) {
+  return feature_file+".index";
+}
+
+void LoadExtractedHashes(const std::string &feature_file, std::set<std::string> &hashes) {
+  std::ifstream index(ExtractedIndexPath(feature_file).c_str());
+  std::string hash;
+  while(index >> hash) hashes.insert(hash);
+}
+
+void AppendExtractedHash(const std::string &feature_file, const std::string &hash) {
+  std::ofstream index(ExtractedIndexPath(feature_file).c_str(), std::ios::out|std::ios::app);
+  index << hash << "\n";
+}
@@ -0,0 +1,65 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  dataset_manifest.h
+ *
+ *    Description:  Persistent per-video index of a training corpus
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 11시 05분 47초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_DATASET_MANIFEST_H_
+#define VIDEOTRAINER_DATASET_MANIFEST_H_
+
+#include <set>
+#include <string>
+#include <vector>
+
+struct ManifestEntry {
+  int label;             // +1 positive, -1 negative
+  std::string path;
+  long long file_size;
+  long long modified;    // seconds since epoch
+  std::string hash;      // hex digest, see ContentHash()
+  int frame_count;       // <=0 when the container does not report it
+  double fps;
+  int width;
+  int height;
+  std::string codec;     // fourcc
+};
+
+// Manifest files are plain text: a version line followed by one
+// tab-separated entry per video, path last.
+bool LoadManifest(const std::string &manifest_file, std::vector<ManifestEntry> &entries);
+bool SaveManifest(const std::string &manifest_file, const std::vector<ManifestEntry> &entries);
+
+// 64-bit FNV-1a over the file size and its first and last MiB. Cheap enough
+// for terabyte corpora while still catching re-encodes and truncation.
+std::string ContentHash(const std::string &path);
+
+// Fills every field of `entry` from the file on disk. Returns false if the
+// file cannot be opened as a video.
+bool ProbeVideo(const std::string &path, int label, ManifestEntry &entry);
+
+// Whether size and modification time still match the file on disk.
+bool IsUnchanged(const ManifestEntry &entry);
+
+// Splits the entries with `label` into the path and frame-count lists the
+// segment planner takes.
+void SelectVideos(const std::vector<ManifestEntry> &entries, int label,
+                  std::vector<std::string> &videos, std::vector<int> &frame_counts);
+
+// The sidecar next to a feature file lists the hashes of videos whose rows
+// it already holds, so re-runs can skip them.
+std::string ExtractedIndexPath(const std::string &feature_file);
+void LoadExtractedHashes(const std::string &feature_file, std::set<std::string> &hashes);
+void AppendExtractedHash(const std::string &feature_file, const std::string &hash);
+
+#endif
@@ -0,0 +1,123 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detection_client.cpp
+ *
+ *    Description:  Client side of the svmserver detection protocol
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "detection_client.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <boost/algorithm/string.hpp>
+
+DetectionClient::DetectionClient() : socket_fd_(-1), buffer_id_(0), next_request_(0) {}
+
+DetectionClient::~DetectionClient() {
+  Close();
+}
+
+bool DetectionClient::Connect(const std::string &socket_path) {
+  Close();
+  socket_fd_=ConnectUnixSocket(socket_path);
+  if(socket_fd_<0) return false;
+
+  MessageHeader header;
+  if(!ReceiveMessage(socket_fd_, header, payload_) || header.type!=kHelloMessage
+     || payload_.size()<sizeof(DetectionHello)) {
+    Close();
+    return false;
+  }
+  DetectionHello hello;
+  memcpy(&hello, &payload_[0], sizeof(hello));
+  if(hello.version!=kDetectionProtocolVersion) {
+    Close();
+    return false;
+  }
+  const std::string names(payload_.begin()+sizeof(hello), payload_.end());
+  detector_names_.clear();
+  if(!names.empty()) boost::split(detector_names_, names, boost::is_any_of("\n"));
+  detector_names_.resize(hello.detector_count);
+  return true;
+}
+
+void DetectionClient::Close() {
+  if(socket_fd_>=0) close(socket_fd_);
+  socket_fd_=-1;
+  buffer_.Reset();
+  detector_names_.clear();
+}
+
+bool DetectionClient::Reserve(size_t size) {
+  if(buffer_.data() && buffer_.size()>=size) return true;
+  // The server keeps the old buffer mapped until it sees the new id; a
+  // fresh object is simpler than growing a mapping both sides hold.
+  if(!buffer_.Create(size)) return false;
+  AttachBuffer attach;
+  attach.buffer_id=++buffer_id_;
+  attach.reserved=0;
+  attach.size=buffer_.size();
+  return SendMessage(socket_fd_, kAttachBufferMessage, &attach, sizeof(attach), buffer_.fd());
+}
+
+cv::Mat DetectionClient::FrameBuffer(int rows, int cols, int channels) {
+  if(socket_fd_<0 || !Reserve((size_t)rows*cols*channels)) return cv::Mat();
+  return cv::Mat(rows, cols, CV_8UC(channels), buffer_.data());
+}
+
+bool DetectionClient::Detect(const cv::Mat &frame, int detector, std::vector<ScoredDetection> &detections) {
+  detections.clear();
+  if(socket_fd_<0 || frame.empty() || frame.depth()!=CV_8U) return false;
+
+  const char *begin=(const char *)frame.data;
+  const size_t span=(frame.rows-1)*frame.step[0]+frame.cols*frame.elemSize();
+  const bool shared=buffer_.data() && begin>=buffer_.data() && begin+span<=buffer_.data()+buffer_.size();
+
+  DetectRequest request;
+  memset(&request, 0, sizeof(request));
+  request.request_id=++next_request_;
+  request.detector=(uint32_t)detector;
+  request.rows=frame.rows;
+  request.cols=frame.cols;
+  request.channels=frame.channels();
+  if(shared) {
+    request.offset=begin-buffer_.data();
+    request.step=frame.step[0];
+  } else {
+    cv::Mat target=FrameBuffer(frame.rows, frame.cols, frame.channels());
+    if(target.empty()) return false;
+    frame.copyTo(target);
+    request.offset=0;
+    request.step=target.step[0];
+  }
+  request.buffer_id=buffer_id_;
+  if(!SendMessage(socket_fd_, kDetectMessage, &request, sizeof(request))) return false;
+
+  MessageHeader header;
+  if(!ReceiveMessage(socket_fd_, header, payload_) || header.type!=kDetectionsMessage
+     || payload_.size()<sizeof(DetectionsReply)) return false;
+  DetectionsReply reply;
+  memcpy(&reply, &payload_[0], sizeof(reply));
+  if(reply.request_id!=request.request_id || reply.status!=kDetectionOk
+     || payload_.size()<sizeof(reply)+(size_t)reply.count*sizeof(WireDetection)) return false;
+
+  detections.resize(reply.count);
+  for(uint32_t i=0; i<reply.count; i++) {
+    WireDetection wire;
+    memcpy(&wire, &payload_[sizeof(reply)+i*sizeof(wire)], sizeof(wire));
+    detections[i].box=cv::Rect(wire.x, wire.y, wire.width, wire.height);
+    detections[i].score=wire.score;
+  }
+  return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detection_client.h
+ *
+ *    Description:  Client side of the svmserver detection protocol
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_DETECTION_CLIENT_H_
+#define VIDEOTRAINER_DETECTION_CLIENT_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "detection_protocol.h"
+#include "nms.h"
+
+// One connection to svmserver with one shared frame buffer. Not thread
+// safe; a producer that wants several frames in flight opens several
+// clients.
+class DetectionClient {
+ public:
+  DetectionClient();
+  ~DetectionClient();
+
+  bool Connect(const std::string &socket_path);
+  void Close();
+
+  const std::vector<std::string> &detector_names() const { return detector_names_; }
+
+  // A Mat backed by the shared buffer, grown (and re-attached) as needed.
+  // Decoding or resizing straight into it saves the copy Detect() would
+  // otherwise make.
+  cv::Mat FrameBuffer(int rows, int cols, int channels);
+
+  // Runs `detector` on an 8-bit 1- or 3-channel frame and blocks for the
+  // scored boxes. A frame living in FrameBuffer() is sent by reference.
+  bool Detect(const cv::Mat &frame, int detector, std::vector<ScoredDetection> &detections);
+
+ private:
+  DetectionClient(const DetectionClient &);
+  DetectionClient &operator=(const DetectionClient &);
+
+  bool Reserve(size_t size);
+
+  int socket_fd_;
+  uint32_t buffer_id_;
+  uint64_t next_request_;
+  SharedFrameBuffer buffer_;
+  std::vector<std::string> detector_names_;
+  std::vector<char> payload_;
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detection_protocol.cpp
+ *
+ *    Description:  Unix socket protocol between svmserver and its clients
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "detection_protocol.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Payloads are a few hundred bytes; anything larger is a broken peer.
+const uint32_t kMaxPayloadBytes = 1<<24;
+
+bool ReadFully(int fd, void *data, size_t size) {
+  char *cursor=(char *)data;
+  while(size>0) {
+    const ssize_t read_bytes=read(fd, cursor, size);
+    if(read_bytes<0 && errno==EINTR) continue;
+    if(read_bytes<=0) return false;
+    cursor+=read_bytes;
+    size-=read_bytes;
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const void *data, size_t size) {
+  const char *cursor=(const char *)data;
+  while(size>0) {
+    const ssize_t written=send(fd, cursor, size, MSG_NOSIGNAL);
+    if(written<0 && errno==EINTR) continue;
+    if(written<=0) return false;
+    cursor+=written;
+    size-=written;
+  }
+  return true;
+}
+
+bool FillAddress(const std::string &path, sockaddr_un &address) {
+  memset(&address, 0, sizeof(address));
+  address.sun_family=AF_UNIX;
+  if(path.size()>=sizeof(address.sun_path)) return false;
+  memcpy(address.sun_path, path.c_str(), path.size()+1);
+  return true;
+}
+
+}
+
+bool SendMessage(int socket_fd, uint32_t type, const void *payload, size_t size, int pass_fd) {
+  MessageHeader header;
+  header.type=type;
+  header.size=(uint32_t)size;
+  if(pass_fd<0) {
+    return WriteFully(socket_fd, &header, sizeof(header)) && WriteFully(socket_fd, payload, size);
+  }
+
+  // The descriptor rides on the header bytes; the payload follows as usual.
+  iovec vector;
+  vector.iov_base=&header;
+  vector.iov_len=sizeof(header);
+  char control[CMSG_SPACE(sizeof(int))];
+  memset(control, 0, sizeof(control));
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov=&vector;
+  message.msg_iovlen=1;
+  message.msg_control=control;
+  message.msg_controllen=sizeof(control);
+  cmsghdr *rights=CMSG_FIRSTHDR(&message);
+  rights->cmsg_level=SOL_SOCKET;
+  rights->cmsg_type=SCM_RIGHTS;
+  rights->cmsg_len=CMSG_LEN(sizeof(int));
+  memcpy(CMSG_DATA(rights), &pass_fd, sizeof(int));
+
+  ssize_t sent;
+  do sent=sendmsg(socket_fd, &message, MSG_NOSIGNAL); while(sent<0 && errno==EINTR);
+  if(sent<=0) return false;
+  if(sent<(ssize_t)sizeof(header) && !WriteFully(socket_fd, (const char *)&header+sent, sizeof(header)-sent)) return false;
+  return WriteFully(socket_fd, payload, size);
+}
+
+bool ReceiveMessage(int socket_fd, MessageHeader &header, std::vector<char> &payload, int *received_fd) {
+  if(received_fd) *received_fd=-1;
+
+  iovec vector;
+  vector.iov_base=&header;
+  vector.iov_len=sizeof(header);
+  char control[CMSG_SPACE(sizeof(int))];
+  msghdr message;
+  memset(&message, 0, sizeof(message));
+  message.msg_iov=&vector;
+  message.msg_iovlen=1;
+  message.msg_control=control;
+  message.msg_controllen=sizeof(control);
+
+  ssize_t received;
+  do received=recvmsg(socket_fd, &message, MSG_CMSG_CLOEXEC); while(received<0 && errno==EINTR);
+  if(received<=0) return false;
+
+  for(cmsghdr *rights=CMSG_FIRSTHDR(&message); rights; rights=CMSG_NXTHDR(&message, rights)) {
+    if(rights->cmsg_level!=SOL_SOCKET || rights->cmsg_type!=SCM_RIGHTS) continue;
+    int fd;
+    memcpy(&fd, CMSG_DATA(rights), sizeof(int));
+    if(received_fd && *received_fd<0) *received_fd=fd;
+    else close(fd);
+  }
+
+  if(received<(ssize_t)sizeof(header) && !ReadFully(socket_fd, (char *)&header+received, sizeof(header)-received)) return false;
+  if(header.size>kMaxPayloadBytes) return false;
+  payload.resize(header.size);
+  return header.size==0 || ReadFully(socket_fd, &payload[0], header.size);
+}
+
+int ListenUnixSocket(const std::string &path, int backlog) {
+  sockaddr_un address;
+  if(!FillAddress(path, address)) return -1;
+  const int fd=socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+  if(fd<0) return -1;
+  unlink(path.c_str());
+  if(bind(fd, (sockaddr *)&address, sizeof(address))<0 || listen(fd, backlog)<0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+int ConnectUnixSocket(const std::string &path) {
+  sockaddr_un address;
+  if(!FillAddress(path, address)) return -1;
+  const int fd=socket(AF_UNIX, SOCK_STREAM|SOCK_CLOEXEC, 0);
+  if(fd<0) return -1;
+  if(connect(fd, (sockaddr *)&address, sizeof(address))<0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+bool SharedFrameBuffer::Create(size_t size) {
+  Reset();
+  const int fd=memfd_create("videotrainer-frames", MFD_CLOEXEC|MFD_ALLOW_SEALING);
+  if(fd<0) return false;
+  if(ftruncate(fd, size)<0 || fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK)<0) {
+    close(fd);
+    return false;
+  }
+  return Map(fd, size, true);
+}
+
+bool SharedFrameBuffer::Map(int fd, size_t size, bool writable) {
+  Reset();
+  // A peer claiming more than the object holds, or able to shrink it
+  // later, would fault the reader with SIGBUS.
+  // F_GET_SEALS fails (-1, every bit set) on objects that cannot be sealed.
+  struct stat status;
+  const int seals=fcntl(fd, F_GET_SEALS);
+  if(size==0 || fstat(fd, &status)<0 || (uint64_t)status.st_size<size
+     || seals<0 || !(seals&F_SEAL_SHRINK)) {
+    close(fd);
+    return false;
+  }
+  void *data=mmap(0, size, writable ? PROT_READ|PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  if(data==MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+  fd_=fd;
+  data_=(char *)data;
+  size_=size;
+  return true;
+}
+
+void SharedFrameBuffer::Reset() {
+  if(data_) munmap(data_, size_);
+  if(fd_>=0) close(fd_);
+  fd_=-1;
+  data_=0;
+  size_=0;
+}
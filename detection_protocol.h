@@ -0,0 +1,129 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detection_protocol.h
+ *
+ *    Description:  Unix socket protocol between svmserver and its clients
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_DETECTION_PROTOCOL_H_
+#define VIDEOTRAINER_DETECTION_PROTOCOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+// Clients and the server share one machine, so messages are fixed-layout
+// native-endian structs behind a small header. Pixels never go through the
+// socket: a client creates a shared-memory buffer, passes its descriptor
+// once with kAttachBuffer (SCM_RIGHTS) and then only names a region of it
+// in each kDetect request. The client must leave that region alone until
+// the matching kDetections reply arrives.
+const uint32_t kDetectionProtocolVersion = 1;
+
+enum DetectionMessageType {
+  kHelloMessage = 1,         // server -> client: DetectionHello + detector names, '\n' separated
+  kAttachBufferMessage = 2,  // client -> server: AttachBuffer + descriptor
+  kDetectMessage = 3,        // client -> server: DetectRequest
+  kDetectionsMessage = 4     // server -> client: DetectionsReply + count x WireDetection
+};
+
+struct MessageHeader {
+  uint32_t type;
+  uint32_t size;  // payload bytes after the header
+};
+
+struct DetectionHello {
+  uint32_t version;
+  uint32_t detector_count;
+};
+
+struct AttachBuffer {
+  uint32_t buffer_id;
+  uint32_t reserved;
+  uint64_t size;
+};
+
+// An 8-bit frame of `channels` (1 or 3, BGR) interleaved channels at
+// `offset` in an attached buffer.
+struct DetectRequest {
+  uint64_t request_id;
+  uint32_t buffer_id;
+  uint32_t detector;
+  uint64_t offset;
+  uint64_t step;
+  int32_t rows;
+  int32_t cols;
+  int32_t channels;
+  int32_t reserved;
+};
+
+enum DetectionStatus {
+  kDetectionOk = 0,
+  kUnknownBuffer = 1,
+  kUnknownDetector = 2,
+  kBadFrame = 3
+};
+
+struct DetectionsReply {
+  uint64_t request_id;
+  int32_t status;
+  uint32_t count;
+};
+
+struct WireDetection {
+  int32_t x, y, width, height;
+  double score;
+};
+
+// Sends one message, optionally passing `pass_fd` along with it.
+bool SendMessage(int socket_fd, uint32_t type, const void *payload, size_t size, int pass_fd=-1);
+
+// Receives one message. A descriptor passed with it is stored in
+// `received_fd` (or closed when that is null); otherwise it is set to -1.
+// Returns false on end of stream or error.
+bool ReceiveMessage(int socket_fd, MessageHeader &header, std::vector<char> &payload, int *received_fd=0);
+
+// Unix domain stream socket helpers. ListenUnixSocket replaces a stale
+// socket file left by a previous run.
+int ListenUnixSocket(const std::string &path, int backlog=64);
+int ConnectUnixSocket(const std::string &path);
+
+// Anonymous shared memory (memfd) sealed against shrinking, so a mapping
+// of it can never fault. The descriptor is what gets passed to the server.
+class SharedFrameBuffer {
+ public:
+  SharedFrameBuffer() : fd_(-1), data_(0), size_(0) {}
+  ~SharedFrameBuffer() { Reset(); }
+
+  bool Create(size_t size);
+  // Maps a descriptor received from a peer, taking ownership of it. Only
+  // shrink-sealed objects at least `size` bytes long are accepted.
+  bool Map(int fd, size_t size, bool writable);
+  void Reset();
+
+  int fd() const { return fd_; }
+  char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  SharedFrameBuffer(const SharedFrameBuffer &);
+  SharedFrameBuffer &operator=(const SharedFrameBuffer &);
+
+  int fd_;
+  char *data_;
+  size_t size_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detector_io.cpp
+ *
+ *    Description:  Reading and writing single-vector HOG detectors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 14시 26분 03초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "detector_io.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <opencv2/opencv.hpp>
+#include <boost/filesystem.hpp>
+
+namespace {
+
+bool IsOpenCVModel(const std::string &detector_file) {
+  const std::string extension=boost::filesystem::path(detector_file).extension().string();
+  return extension==".xml" || extension==".yml" || extension==".yaml";
+}
+
+bool LoadOpenCVModel(const std::string &model_file, std::vector<float> &detector) {
+  cv::Ptr<cv::ml::SVM> svm=cv::ml::StatModel::load<cv::ml::SVM>(model_file);
+  if(svm.empty()) return false;
+
+  // A linear SVM collapses to a single support vector with alpha 1.
+  cv::Mat sv=svm->getSupportVectors();
+  cv::Mat alpha, svidx;
+  const double rho=svm->getDecisionFunction(0, alpha, svidx);
+  if(sv.rows!=1 || sv.type()!=CV_32F || alpha.total()!=1) {
+    std::cerr << "Error: " << model_file << " is not a linear SVM" << std::endl;
+    return false;
+  }
+
+  detector.resize(sv.cols+1);
+  std::memcpy(&detector[0], sv.ptr(), sv.cols*sizeof(detector[0]));
+  detector[sv.cols]=(float)-rho;
+  return true;
+}
+
+}
+
+bool LoadDetector(const std::string &detector_file, std::vector<float> &detector) {
+  detector.clear();
+  if(IsOpenCVModel(detector_file)) return LoadOpenCVModel(detector_file, detector);
+
+  std::ifstream input(detector_file.c_str());
+  if(!input) return false;
+  float value;
+  while(input >> value) detector.push_back(value);
+  return !detector.empty();
+}
+
+bool SaveDetector(const std::string &detector_file, const std::vector<float> &detector) {
+  std::ofstream output(detector_file.c_str(), std::ios::out|std::ios::trunc);
+  if(!output) return false;
+  output.precision(9);
+  for(size_t i=0; i<detector.size(); i++) output << detector[i] << "\n";
+  return (bool)output;
+}
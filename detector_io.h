@@ -0,0 +1,32 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detector_io.h
+ *
+ *    Description:  Reading and writing single-vector HOG detectors
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 14시 26분 03초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_DETECTOR_IO_H_
+#define VIDEOTRAINER_DETECTOR_IO_H_
+
+#include <string>
+#include <vector>
+
+// Loads a detector vector (weights followed by the bias) either from the
+// plain one-value-per-line files the export tools and svmupdate write, or
+// from a linear OpenCV SVM model saved by svmtrainhog (.xml/.yml/.yaml).
+bool LoadDetector(const std::string &detector_file, std::vector<float> &detector);
+
+// Writes one value per line, replacing any existing file.
+bool SaveDetector(const std::string &detector_file, const std::vector<float> &detector);
+
+#endif
@@ -0,0 +1,208 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  extraction_checkpoint.cpp
+ *
+ *    Description:  Durable progress journal for resumable feature extraction
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 21시 40분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "extraction_checkpoint.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+
+namespace {
+
+const char *kCheckpointHeader = "# videotrainer checkpoint v1";
+
+std::string SegmentKey(const std::string &video, int begin_frame, int end_frame, int step) {
+  std::ostringstream key;
+  key << begin_frame << "\t" << end_frame << "\t" << step << "\t" << video;
+  return key.str();
+}
+
+// Size of a file, 0 if it does not exist, -1 on other errors.
+long long FileSize(const std::string &path) {
+  struct stat status;
+  if(stat(path.c_str(), &status)==0) return (long long)status.st_size;
+  return errno==ENOENT ? 0 : -1;
+}
+
+// Flushes a file's data to disk and returns its size. A file that does not
+// exist has size 0 and nothing to flush.
+long long SyncFile(const std::string &path) {
+  const int fd=open(path.c_str(), O_RDONLY);
+  if(fd<0) return errno==ENOENT ? 0 : -1;
+  struct stat status;
+  const bool synced=(fsync(fd)==0 && fstat(fd, &status)==0);
+  close(fd);
+  return synced ? (long long)status.st_size : -1;
+}
+
+// New directory entries only survive a crash once the directory is synced.
+void SyncDirectory(const std::string &path) {
+  std::string directory=boost::filesystem::path(path).parent_path().string();
+  if(directory.empty()) directory=".";
+  const int fd=open(directory.c_str(), O_RDONLY|O_DIRECTORY);
+  if(fd<0) return;
+  fsync(fd);
+  close(fd);
+}
+
+bool TruncateTo(const std::string &path, long long size) {
+  const long long current=FileSize(path);
+  if(current<0) return false;
+  if(current<size) {
+    std::cerr << "Error: " << path << " has " << current << " bytes but the checkpoint recorded "
+              << size << "; it was changed outside this run" << std::endl;
+    return false;
+  }
+  if(current==size) return true;
+  std::cout << "Dropping " << current-size << " bytes of unfinished rows from " << path << std::endl;
+  return truncate(path.c_str(), size)==0 && SyncFile(path)>=0;
+}
+
+bool WriteAll(int fd, const std::string &text) {
+  size_t written=0;
+  while(written<text.size()) {
+    const ssize_t count=write(fd, text.data()+written, text.size()-written);
+    if(count<0) {
+      if(errno==EINTR) continue;
+      return false;
+    }
+    written+=count;
+  }
+  return true;
+}
+
+}
+
+std::string CheckpointPath(const std::string &feature_file) {
+  return feature_file+".ckpt";
+}
+
+ExtractionCheckpoint::ExtractionCheckpoint() : fd_(-1), done_rows_(0) {}
+
+ExtractionCheckpoint::~ExtractionCheckpoint() {
+  if(fd_>=0) close(fd_);
+}
+
+bool ExtractionCheckpoint::Open(const std::string &feature_file, const std::string &runs_file) {
+  feature_file_=feature_file;
+  runs_file_=runs_file;
+  done_.clear();
+  recorded_.clear();
+  done_rows_=0;
+  const std::string path=CheckpointPath(feature_file);
+
+  std::ifstream journal(path.c_str(), std::ios::binary);
+  if(!journal) {
+    // First run: whatever the outputs already hold stays as it is.
+    const long long feature_bytes=SyncFile(feature_file_);
+    const long long runs_bytes=(runs_file_.empty() ? 0 : SyncFile(runs_file_));
+    if(feature_bytes<0 || runs_bytes<0) return false;
+    fd_=open(path.c_str(), O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, 0644);
+    if(fd_<0) return false;
+    std::ostringstream start;
+    start << kCheckpointHeader << "\n" << "base\t" << feature_bytes << "\t" << runs_bytes << "\n";
+    if(!WriteAll(fd_, start.str()) || fsync(fd_)!=0) return false;
+    SyncDirectory(path);
+    return true;
+  }
+
+  std::string line;
+  long long feature_bytes=-1, runs_bytes=-1, complete_bytes=0;
+  bool header=false;
+  while(std::getline(journal, line)) {
+    if(journal.eof()) break;  // no newline: torn by the crash
+    if(!header) {
+      if(line!=kCheckpointHeader) {
+        std::cerr << "Error: " << path << " is not a checkpoint" << std::endl;
+        return false;
+      }
+      header=true;
+    } else {
+      std::istringstream fields(line);
+      std::string kind;
+      std::getline(fields, kind, '\t');
+      // Fields go to locals first: a line that fails halfway, or that
+      // shrinks the outputs, must change nothing.
+      long long line_feature_bytes, line_runs_bytes;
+      int begin_frame, end_frame, step;
+      long long rows;
+      std::string video;
+      const bool segment=(kind=="segment");
+      if(kind=="base") {
+        if(!(fields >> line_feature_bytes >> line_runs_bytes)) break;
+      } else if(segment) {
+        if(!(fields >> begin_frame >> end_frame >> step >> rows >> line_feature_bytes >> line_runs_bytes)
+           || fields.get()!='\t' || !std::getline(fields, video) || video.empty()) break;
+      } else break;
+      // Outputs only ever grow between records.
+      if(line_feature_bytes<std::max(feature_bytes, 0LL) || line_runs_bytes<std::max(runs_bytes, 0LL)) break;
+
+      feature_bytes=line_feature_bytes;
+      runs_bytes=line_runs_bytes;
+      if(segment) {
+        done_.insert(SegmentKey(video, begin_frame, end_frame, step));
+        recorded_[video]++;
+        done_rows_+=rows;
+      }
+    }
+    complete_bytes+=line.size()+1;
+  }
+  journal.close();
+  if(feature_bytes<0) {
+    std::cerr << "Error: " << path << " has no base record" << std::endl;
+    return false;
+  }
+
+  if(!TruncateTo(feature_file_, feature_bytes)) return false;
+  if(!runs_file_.empty() && !TruncateTo(runs_file_, runs_bytes)) return false;
+  if(truncate(path.c_str(), complete_bytes)!=0) return false;
+  fd_=open(path.c_str(), O_WRONLY|O_APPEND);
+  return fd_>=0 && fsync(fd_)==0;
+}
+
+bool ExtractionCheckpoint::IsDone(const std::string &video, const VideoSegment &segment) const {
+  return done_.count(SegmentKey(video, segment.begin_frame, segment.end_frame, segment.step))>0;
+}
+
+int ExtractionCheckpoint::RecordedSegments(const std::string &video) const {
+  std::map<std::string, int>::const_iterator found=recorded_.find(video);
+  return found==recorded_.end() ? 0 : found->second;
+}
+
+bool ExtractionCheckpoint::Commit(const std::string &video, const VideoSegment &segment, long long rows) {
+  const long long feature_bytes=SyncFile(feature_file_);
+  const long long runs_bytes=(runs_file_.empty() ? 0 : SyncFile(runs_file_));
+  if(fd_<0 || feature_bytes<0 || runs_bytes<0) return false;
+
+  std::ostringstream record;
+  record << "segment\t" << segment.begin_frame << "\t" << segment.end_frame << "\t" << segment.step
+         << "\t" << rows << "\t" << feature_bytes << "\t" << runs_bytes << "\t" << video << "\n";
+  if(!WriteAll(fd_, record.str()) || fsync(fd_)!=0) return false;
+  done_.insert(SegmentKey(video, segment.begin_frame, segment.end_frame, segment.step));
+  recorded_[video]++;
+  done_rows_+=rows;
+  return true;
+}
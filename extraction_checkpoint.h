@@ -0,0 +1,75 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  extraction_checkpoint.h
+ *
+ *    Description:  Durable progress journal for resumable feature extraction
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 21시 40분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_EXTRACTION_CHECKPOINT_H_
+#define VIDEOTRAINER_EXTRACTION_CHECKPOINT_H_
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "video_scheduler.h"
+
+// <feature file>.ckpt is an append-only journal: a header, a base line with
+// the sizes the outputs had when the journal was started, then one line
+// per finished segment with its frame range, row count and the sizes of
+// the feature file (and shard runs file) once its rows were in. Outputs
+// are fsync'ed before a line is appended and the journal after, so a
+// line only ever describes rows that are on disk.
+//
+// On open, any bytes past the last recorded sizes -- the rows of a segment
+// that was being written when the process died -- are truncated away, and
+// a torn last journal line is dropped.
+std::string CheckpointPath(const std::string &feature_file);
+
+class ExtractionCheckpoint {
+ public:
+  ExtractionCheckpoint();
+  ~ExtractionCheckpoint();
+
+  // `runs_file` is the shard runs file written alongside, or empty.
+  // Returns false (with a message) if the journal does not match the
+  // outputs, e.g. the feature file is shorter than recorded.
+  bool Open(const std::string &feature_file, const std::string &runs_file);
+
+  // `video` identifies the video across runs: its content hash when known,
+  // otherwise its path.
+  bool IsDone(const std::string &video, const VideoSegment &segment) const;
+
+  // Segments recorded for `video`; more than the plan marks as done means
+  // the segmenting options changed since the rows were written.
+  int RecordedSegments(const std::string &video) const;
+
+  // Call once the segment's rows are written and flushed.
+  bool Commit(const std::string &video, const VideoSegment &segment, long long rows);
+
+  int done_segments() const { return (int)done_.size(); }
+  long long done_rows() const { return done_rows_; }
+
+ private:
+  ExtractionCheckpoint(const ExtractionCheckpoint &);
+  ExtractionCheckpoint &operator=(const ExtractionCheckpoint &);
+
+  std::string feature_file_;
+  std::string runs_file_;
+  int fd_;
+  std::set<std::string> done_;
+  std::map<std::string, int> recorded_;
+  long long done_rows_;
+};
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_file.cpp
+ *
+ *    Description:  Dense in-memory form of libsvm/svmlight feature files
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 13시 32분 14초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "feature_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "work_stealing.h"
+
+namespace {
+
+const size_t kMinChunkBytes = 1<<20;
+
+struct Chunk {
+  const char *begin;
+  const char *end;
+  int rows;
+  int max_index;
+  int first_row;
+};
+
+void Widen(FeatureMatrix &matrix, int cols) {
+  if(cols<=matrix.cols) return;
+  if(matrix.storage!=kFloat32Storage) {
+    const size_t row_bytes=EncodedRowBytes(matrix.storage, cols);
+    std::vector<unsigned char> widened((size_t)matrix.rows*row_bytes);
+    std::vector<float> scratch(cols, 0.f);
+    for(int i=0; i<matrix.rows; i++) {
+      matrix.row(i, scratch.data());
+      EncodeRow(matrix.storage, scratch.data(), cols, &widened[(size_t)i*row_bytes]);
+    }
+    matrix.packed.swap(widened);
+    matrix.cols=cols;
+    return;
+  }
+  std::vector<float> widened((size_t)matrix.rows*cols, 0.f);
+  for(int i=0; i<matrix.rows; i++) {
+    std::copy(matrix.row(i), matrix.row(i)+matrix.cols, widened.begin()+(size_t)i*cols);
+  }
+  matrix.values.swap(widened);
+  matrix.cols=cols;
+}
+
+// Rows and encoded bytes follow `rows`; new rows start out zero.
+void ResizeRows(FeatureMatrix &matrix, int rows) {
+  if(matrix.storage==kFloat32Storage) matrix.values.resize((size_t)rows*matrix.cols, 0.f);
+  else matrix.packed.resize((size_t)rows*matrix.row_bytes(), 0);
+  matrix.labels.resize(rows);
+  matrix.rows=rows;
+}
+
+const char *SkipBlanks(const char *cursor, const char *end) {
+  while(cursor<end && (*cursor==' ' || *cursor=='\t' || *cursor=='\r')) cursor++;
+  return cursor;
+}
+
+// End of the data part of a line: svmlight allows a trailing "# comment".
+const char *DataEnd(const char *line, const char *line_end) {
+  const char *comment=(const char *)std::memchr(line, '#', line_end-line);
+  return comment ? comment : line_end;
+}
+
+// from_chars takes no leading '+', which every positive label has.
+std::from_chars_result ParseFloat(const char *cursor, const char *end, float &value) {
+  if(cursor<end && *cursor=='+') cursor++;
+  return std::from_chars(cursor, end, value);
+}
+
+// First pass: count the rows of a chunk and find its widest index without
+// parsing values; in "idx:val" rows the last index sits before the last ':'.
+void SizeChunk(Chunk &chunk) {
+  chunk.rows=0;
+  chunk.max_index=0;
+  const char *line=chunk.begin;
+  while(line<chunk.end) {
+    const char *newline=(const char *)std::memchr(line, '\n', chunk.end-line);
+    const char *line_end=(newline ? newline : chunk.end);
+    const char *data_end=DataEnd(line, line_end);
+    if(SkipBlanks(line, data_end)<data_end) {
+      chunk.rows++;
+      const char *colon=data_end;
+      while(colon>line && *(colon-1)!=':') colon--;
+      if(colon>line) {
+        const char *digits=colon-1;
+        while(digits>line && *(digits-1)>='0' && *(digits-1)<='9') digits--;
+        int index=0;
+        std::from_chars(digits, colon-1, index);
+        chunk.max_index=std::max(chunk.max_index, index);
+      }
+    }
+    line=line_end+1;
+  }
+}
+
+// Second pass: parse every row of a chunk into its slot of the matrix.
+// Returns false with the offending line on malformed input.
+bool ParseChunk(const Chunk &chunk, FeatureMatrix &matrix, const char *&bad_line) {
+  const bool encoded=(matrix.storage!=kFloat32Storage);
+  std::vector<float> scratch(encoded ? matrix.cols : 0);
+  int row_index=chunk.first_row;
+  const char *line=chunk.begin;
+  while(line<chunk.end) {
+    const char *newline=(const char *)std::memchr(line, '\n', chunk.end-line);
+    const char *line_end=(newline ? newline : chunk.end);
+    const char *data_end=DataEnd(line, line_end);
+    const char *cursor=SkipBlanks(line, data_end);
+    if(cursor<data_end) {
+      float label;
+      std::from_chars_result parsed=ParseFloat(cursor, data_end, label);
+      if(parsed.ec!=std::errc()) {
+        bad_line=line;
+        return false;
+      }
+      matrix.labels[row_index]=label;
+      float *row=(encoded ? scratch.data() : matrix.row(row_index));
+      if(encoded) std::fill(scratch.begin(), scratch.end(), 0.f);
+      cursor=SkipBlanks(parsed.ptr, data_end);
+      while(cursor<data_end) {
+        int index;
+        parsed=std::from_chars(cursor, data_end, index);
+        if(parsed.ec!=std::errc() || parsed.ptr>=data_end || *parsed.ptr!=':'
+           || index<1 || index>matrix.cols) {
+          bad_line=line;
+          return false;
+        }
+        float value;
+        parsed=ParseFloat(parsed.ptr+1, data_end, value);
+        if(parsed.ec!=std::errc()) {
+          bad_line=line;
+          return false;
+        }
+        row[index-1]=value;
+        cursor=SkipBlanks(parsed.ptr, data_end);
+      }
+      if(encoded) EncodeRow(matrix.storage, row, matrix.cols, matrix.packed_row(row_index));
+      row_index++;
+    }
+    line=line_end+1;
+  }
+  return true;
+}
+
+}
+
+bool ReadFeatureFile(const std::string &feature_file, FeatureMatrix &matrix, int thread_count) {
+  boost::system::error_code error;
+  const boost::uintmax_t file_size=boost::filesystem::file_size(feature_file, error);
+  if(error) return false;
+  if(file_size==0) return true;
+
+  namespace bip=boost::interprocess;
+  bip::file_mapping mapping;
+  bip::mapped_region region;
+  try {
+    bip::file_mapping(feature_file.c_str(), bip::read_only).swap(mapping);
+    bip::mapped_region(mapping, bip::read_only).swap(region);
+  }
+  catch(bip::interprocess_exception &e) {
+    std::cerr << "Error mapping " << feature_file << ": " << e.what() << std::endl;
+    return false;
+  }
+  region.advise(bip::mapped_region::advice_sequential);
+  const char *data=(const char *)region.get_address();
+  const char *data_end=data+region.get_size();
+
+  // Cut at newlines into a few chunks per worker so stealing can even out
+  // rows of different length.
+  WorkStealingPool pool(thread_count);
+  const size_t target_chunks=std::max<size_t>(1, std::min<size_t>(pool.thread_count()*4, region.get_size()/kMinChunkBytes));
+  std::vector<Chunk> chunks;
+  const char *chunk_begin=data;
+  for(size_t i=1; i<=target_chunks && chunk_begin<data_end; i++) {
+    const char *chunk_end=data_end;
+    if(i<target_chunks) {
+      const char *split=data+region.get_size()*i/target_chunks;
+      if(split<chunk_begin) continue;
+      const char *newline=(const char *)std::memchr(split, '\n', data_end-split);
+      chunk_end=(newline ? newline+1 : data_end);
+    }
+    Chunk chunk;
+    chunk.begin=chunk_begin;
+    chunk.end=chunk_end;
+    chunks.push_back(chunk);
+    chunk_begin=chunk_end;
+  }
+
+  pool.Run((int)chunks.size(), [&](int task, int) { SizeChunk(chunks[task]); });
+
+  const int first_row=matrix.rows;
+  int rows=matrix.rows;
+  int cols=matrix.cols;
+  for(size_t i=0; i<chunks.size(); i++) {
+    chunks[i].first_row=rows;
+    rows+=chunks[i].rows;
+    cols=std::max(cols, chunks[i].max_index);
+  }
+  Widen(matrix, cols);
+  ResizeRows(matrix, rows);
+
+  std::atomic<bool> failed(false);
+  std::vector<const char *> bad_lines(chunks.size(), (const char *)0);
+  pool.Run((int)chunks.size(), [&](int task, int) {
+    if(!ParseChunk(chunks[task], matrix, bad_lines[task])) failed=true;
+  });
+
+  if(failed) {
+    for(size_t i=0; i<chunks.size(); i++) {
+      if(!bad_lines[i]) continue;
+      const char *line_end=(const char *)std::memchr(bad_lines[i], '\n', data_end-bad_lines[i]);
+      std::string line(bad_lines[i], std::min<size_t>((line_end ? line_end : data_end)-bad_lines[i], 80));
+      std::cerr << "Error: " << feature_file << " is not in libsvm format near: " << line << std::endl;
+      break;
+    }
+    ResizeRows(matrix, first_row);
+    return false;
+  }
+  return true;
+}
+
+void WriteFeatureRows(std::ostream &output, const FeatureMatrix &matrix, const std::vector<int> &rows) {
+  std::vector<float> scratch(matrix.cols);
+  for(size_t i=0; i<rows.size(); i++) {
+    const float *row=matrix.row(rows[i], scratch.data());
+    output << (matrix.labels[rows[i]]>0 ? "+1" : "-1");
+    for(int feature_index=0; feature_index<matrix.cols; feature_index++) {
+      output << " " << (feature_index+1) << ":" << row[feature_index];
+    }
+    output << "\n";
+  }
+}
@@ -0,0 +1,74 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_file.h
+ *
+ *    Description:  Dense in-memory form of libsvm/svmlight feature files
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 13시 32분 14초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_FEATURE_FILE_H_
+#define VIDEOTRAINER_FEATURE_FILE_H_
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "feature_storage.h"
+
+// Row-major rows x cols matrix with one label per row, the layout
+// svmtrain's "label idx:val ..." rows describe. Rows are plain floats in
+// `values`, or, with a compact `storage` chosen before the first read,
+// encoded rows of row_bytes() each in `packed`.
+struct FeatureMatrix {
+  int rows;
+  int cols;
+  FeatureStorage storage;
+  std::vector<float> values;
+  std::vector<unsigned char> packed;
+  std::vector<float> labels;
+
+  FeatureMatrix() : rows(0), cols(0), storage(kFloat32Storage) {}
+
+  // Float storage only.
+  float *row(int i) { return &values[(size_t)i*cols]; }
+  const float *row(int i) const { return &values[(size_t)i*cols]; }
+
+  size_t row_bytes() const { return EncodedRowBytes(storage, cols); }
+  unsigned char *packed_row(int i) { return &packed[(size_t)i*row_bytes()]; }
+  const unsigned char *packed_row(int i) const { return &packed[(size_t)i*row_bytes()]; }
+
+  // Row i under any storage: the row itself for floats, otherwise decoded
+  // into `scratch`, which must hold cols values.
+  const float *row(int i, float *scratch) const {
+    if(storage==kFloat32Storage) return row(i);
+    DecodeRow(storage, packed_row(i), cols, scratch);
+    return scratch;
+  }
+
+  size_t memory_bytes() const { return values.size()*sizeof(float)+packed.size()+labels.size()*sizeof(float); }
+};
+
+// Appends the rows of a libsvm/svmlight text file. Indices are 1-based and
+// may be sparse; missing entries are zero. A file with wider rows than the
+// matrix already holds widens it.
+//
+// The file is memory-mapped and cut at line boundaries into chunks that are
+// parsed in parallel with std::from_chars straight into the preallocated
+// matrix: one pass sizes every chunk, the second fills its rows. Under a
+// compact storage each row is parsed into a float buffer and encoded, so
+// the matrix never holds a float copy.
+bool ReadFeatureFile(const std::string &feature_file, FeatureMatrix &matrix, int thread_count=0);
+
+// Writes the selected rows back in "label idx:val ..." form.
+void WriteFeatureRows(std::ostream &output, const FeatureMatrix &matrix, const std::vector<int> &rows);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_shard.cpp
+ *
+ *    Description:  Splitting feature extraction across processes
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 12시 18분 09초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "feature_shard.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+Shard ParseShard(const std::string &spec) {
+  Shard shard;
+  char slash=0;
+  std::istringstream fields(spec);
+  if(!(fields >> shard.index >> slash >> shard.count) || slash!='/' || !fields.eof()
+     || shard.count<=0 || shard.index<0 || shard.index>=shard.count) {
+    throw std::invalid_argument("shard must be i/N with 0<=i<N, got "+spec);
+  }
+  return shard;
+}
+
+namespace {
+
+struct LongestFirst {
+  const std::vector<int> *frame_counts;
+  bool operator()(int a, int b) const {
+    if((*frame_counts)[a]!=(*frame_counts)[b]) return (*frame_counts)[a]>(*frame_counts)[b];
+    return a<b;
+  }
+};
+
+}
+
+void AssignShard(const Shard &shard,
+                 const std::vector<int> &frame_counts,
+                 int video_count,
+                 std::vector<char> &owned) {
+  owned.assign(video_count, 0);
+  if((int)frame_counts.size()!=video_count) {
+    for(int i=shard.index; i<video_count; i+=shard.count) owned[i]=1;
+    return;
+  }
+
+  std::vector<int> order(video_count);
+  for(int i=0; i<video_count; i++) order[i]=i;
+  LongestFirst longest_first;
+  longest_first.frame_counts=&frame_counts;
+  std::sort(order.begin(), order.end(), longest_first);
+
+  std::vector<long long> load(shard.count, 0);
+  for(int i=0; i<video_count; i++) {
+    const int target=(int)(std::min_element(load.begin(), load.end())-load.begin());
+    load[target]+=std::max(frame_counts[order[i]], 1);
+    if(target==shard.index) owned[order[i]]=1;
+  }
+}
+
+std::string ShardFeatureFile(const std::string &feature_file, const Shard &shard) {
+  std::ostringstream name;
+  name << feature_file << ".shard-" << shard.index << "-of-" << shard.count;
+  return name.str();
+}
+
+std::string ShardRunsFile(const std::string &shard_feature_file) {
+  return shard_feature_file+".runs";
+}
+
+void AppendShardRun(const std::string &shard_feature_file, const ShardRun &run) {
+  std::ofstream runs(ShardRunsFile(shard_feature_file).c_str(), std::ios::out|std::ios::app);
+  runs << run.label << "\t" << run.rows << "\t" << run.video_path << "\n";
+}
+
+bool LoadShardRuns(const std::string &shard_feature_file, std::vector<ShardRun> &runs) {
+  std::ifstream file(ShardRunsFile(shard_feature_file).c_str());
+  if(!file) return false;
+  std::string line;
+  while(std::getline(file, line)) {
+    if(line.empty()) continue;
+    std::istringstream fields(line);
+    ShardRun run;
+    fields >> run.label >> run.rows;
+    fields.get();
+    if(!fields || !std::getline(fields, run.video_path)) return false;
+    // Segments of one video are recorded separately; fold them together.
+    if(!runs.empty() && runs.back().video_path==run.video_path && runs.back().label==run.label) {
+      runs.back().rows+=run.rows;
+    } else runs.push_back(run);
+  }
+  return true;
+}
+
+bool ShardRunBefore(const ShardRun &a, const ShardRun &b) {
+  if(a.label!=b.label) return a.label>b.label;
+  return a.video_path<b.video_path;
+}
@@ -0,0 +1,58 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_shard.h
+ *
+ *    Description:  Splitting feature extraction across processes
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 12시 18분 09초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_FEATURE_SHARD_H_
+#define VIDEOTRAINER_FEATURE_SHARD_H_
+
+#include <string>
+#include <vector>
+
+struct Shard {
+  int index;
+  int count;
+};
+
+// A run of consecutive rows in a shard's feature file that came from one
+// video. Runs are what featuremerge interleaves.
+struct ShardRun {
+  int label;
+  std::string video_path;
+  long long rows;
+};
+
+// Parses "i/N" with 0<=i<N. Throws std::invalid_argument otherwise.
+Shard ParseShard(const std::string &spec);
+
+// Picks the videos shard.index owns. With known frame counts videos go to
+// the least loaded shard, longest first; otherwise they are dealt
+// round-robin. Every process computes the same split from the same list.
+void AssignShard(const Shard &shard,
+                 const std::vector<int> &frame_counts,
+                 int video_count,
+                 std::vector<char> &owned);
+
+std::string ShardFeatureFile(const std::string &feature_file, const Shard &shard);
+std::string ShardRunsFile(const std::string &shard_feature_file);
+
+void AppendShardRun(const std::string &shard_feature_file, const ShardRun &run);
+bool LoadShardRuns(const std::string &shard_feature_file, std::vector<ShardRun> &runs);
+
+// Global row order: positives before negatives, then by video path, which is
+// the order a single unsharded svmtrain run writes.
+bool ShardRunBefore(const ShardRun &a, const ShardRun &b);
+
+#endif
@@ -0,0 +1,228 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_storage.cpp
+ *
+ *    Description:  Compact row encodings for in-memory feature matrices
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 19시 52분 08초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "feature_storage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VIDEOTRAINER_X86 1
+#endif
+
+namespace {
+
+int QuantizedBlocks(int cols) {
+  return (cols+kQuantizedBlock-1)/kQuantizedBlock;
+}
+
+// Round-to-nearest-even float <-> IEEE half, for CPUs without F16C and
+// for the tails of vector loops.
+uint16_t FloatToHalf(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint16_t sign=(uint16_t)((bits>>16)&0x8000);
+  const uint32_t magnitude=bits&0x7fffffff;
+  if(magnitude>=0x7f800000) return sign|0x7c00|(magnitude>0x7f800000 ? 0x200 : 0);
+  if(magnitude>=0x477ff000) return sign|0x7c00;  // rounds past the largest half
+  if(magnitude<0x38800000) {
+    // Subnormal half: shift the implicit-one mantissa into place.
+    if(magnitude<0x33000000) return sign;
+    const uint32_t shift=126-(magnitude>>23);
+    const uint32_t mantissa=(magnitude&0x7fffff)|0x800000;
+    uint32_t half=mantissa>>shift;
+    const uint32_t rest=mantissa&((1u<<shift)-1);
+    const uint32_t halfway=1u<<(shift-1);
+    if(rest>halfway || (rest==halfway && (half&1))) half++;
+    return sign|(uint16_t)half;
+  }
+  uint32_t half=((magnitude-0x38000000)>>13);
+  const uint32_t rest=magnitude&0x1fff;
+  if(rest>0x1000 || (rest==0x1000 && (half&1))) half++;
+  return sign|(uint16_t)half;
+}
+
+float HalfToFloat(uint16_t half) {
+  const uint32_t sign=(uint32_t)(half&0x8000)<<16;
+  uint32_t exponent=(half>>10)&0x1f;
+  uint32_t mantissa=half&0x3ff;
+  uint32_t bits;
+  if(exponent==0x1f) bits=sign|0x7f800000|(mantissa<<13);
+  else if(exponent!=0) bits=sign|((exponent+112)<<23)|(mantissa<<13);
+  else if(mantissa==0) bits=sign;
+  else {
+    exponent=113;
+    while(!(mantissa&0x400)) {
+      mantissa<<=1;
+      exponent--;
+    }
+    bits=sign|(exponent<<23)|((mantissa&0x3ff)<<13);
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void EncodeHalfScalar(const float *row, int begin, int cols, uint16_t *encoded) {
+  for(int j=begin; j<cols; j++) encoded[j]=FloatToHalf(row[j]);
+}
+
+void DecodeHalfScalar(const uint16_t *encoded, int begin, int cols, float *row) {
+  for(int j=begin; j<cols; j++) row[j]=HalfToFloat(encoded[j]);
+}
+
+void DecodeCodesScalar(const int8_t *codes, float scale, int count, float *row) {
+  for(int j=0; j<count; j++) row[j]=scale*codes[j];
+}
+
+#ifdef VIDEOTRAINER_X86
+
+__attribute__((target("avx,f16c")))
+void EncodeHalfF16c(const float *row, int cols, uint16_t *encoded) {
+  int j=0;
+  for(; j+8<=cols; j+=8) {
+    const __m128i half=_mm256_cvtps_ph(_mm256_loadu_ps(row+j), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128((__m128i *)(encoded+j), half);
+  }
+  EncodeHalfScalar(row, j, cols, encoded);
+}
+
+__attribute__((target("avx,f16c")))
+void DecodeHalfF16c(const uint16_t *encoded, int cols, float *row) {
+  int j=0;
+  for(; j+8<=cols; j+=8) {
+    _mm256_storeu_ps(row+j, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(encoded+j))));
+  }
+  DecodeHalfScalar(encoded, j, cols, row);
+}
+
+__attribute__((target("avx2")))
+void DecodeCodesAvx2(const int8_t *codes, float scale, int count, float *row) {
+  const __m256 factor=_mm256_set1_ps(scale);
+  int j=0;
+  for(; j+8<=count; j+=8) {
+    const __m256i wide=_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(codes+j)));
+    _mm256_storeu_ps(row+j, _mm256_mul_ps(factor, _mm256_cvtepi32_ps(wide)));
+  }
+  DecodeCodesScalar(codes+j, scale, count-j, row+j);
+}
+
+bool HasF16c() {
+  static const bool supported=__builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+  return supported;
+}
+
+bool HasAvx2() {
+  static const bool supported=__builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#endif
+
+}
+
+bool ParseFeatureStorage(const std::string &name, FeatureStorage &storage) {
+  if(name=="f32") storage=kFloat32Storage;
+  else if(name=="f16") storage=kFloat16Storage;
+  else if(name=="q8") storage=kQuantized8Storage;
+  else return false;
+  return true;
+}
+
+const char *FeatureStorageName(FeatureStorage storage) {
+  switch(storage) {
+    case kFloat32Storage: return "f32";
+    case kFloat16Storage: return "f16";
+    case kQuantized8Storage: return "q8";
+  }
+  return "unknown";
+}
+
+size_t EncodedRowBytes(FeatureStorage storage, int cols) {
+  size_t bytes=0;
+  switch(storage) {
+    case kFloat32Storage: bytes=(size_t)cols*sizeof(float); break;
+    case kFloat16Storage: bytes=(size_t)cols*sizeof(uint16_t); break;
+    case kQuantized8Storage: bytes=(size_t)QuantizedBlocks(cols)*sizeof(float)+cols; break;
+  }
+  return (bytes+3)&~(size_t)3;
+}
+
+// A q8 row is its block scales followed by the int8 codes; each block maps
+// its largest magnitude to 127.
+void EncodeRow(FeatureStorage storage, const float *row, int cols, unsigned char *encoded) {
+  if(storage==kFloat32Storage) {
+    std::memcpy(encoded, row, (size_t)cols*sizeof(float));
+  } else if(storage==kFloat16Storage) {
+    uint16_t *halves=(uint16_t *)encoded;
+#ifdef VIDEOTRAINER_X86
+    if(HasF16c()) {
+      EncodeHalfF16c(row, cols, halves);
+      return;
+    }
+#endif
+    EncodeHalfScalar(row, 0, cols, halves);
+  } else {
+    const int blocks=QuantizedBlocks(cols);
+    int8_t *codes=(int8_t *)(encoded+(size_t)blocks*sizeof(float));
+    for(int b=0; b<blocks; b++) {
+      const int begin=b*kQuantizedBlock;
+      const int end=std::min(cols, begin+kQuantizedBlock);
+      float largest=0.f;
+      for(int j=begin; j<end; j++) largest=std::max(largest, std::fabs(row[j]));
+      const float scale=largest/127.f;
+      std::memcpy(encoded+b*sizeof(float), &scale, sizeof(scale));
+      for(int j=begin; j<end; j++) {
+        codes[j]=(int8_t)(scale>0.f ? std::max(-127.f, std::min(127.f, std::nearbyint(row[j]/scale))) : 0.f);
+      }
+    }
+  }
+}
+
+void DecodeRow(FeatureStorage storage, const unsigned char *encoded, int cols, float *row) {
+  if(storage==kFloat32Storage) {
+    std::memcpy(row, encoded, (size_t)cols*sizeof(float));
+  } else if(storage==kFloat16Storage) {
+    const uint16_t *halves=(const uint16_t *)encoded;
+#ifdef VIDEOTRAINER_X86
+    if(HasF16c()) {
+      DecodeHalfF16c(halves, cols, row);
+      return;
+    }
+#endif
+    DecodeHalfScalar(halves, 0, cols, row);
+  } else {
+    const int blocks=QuantizedBlocks(cols);
+    const int8_t *codes=(const int8_t *)(encoded+(size_t)blocks*sizeof(float));
+    for(int b=0; b<blocks; b++) {
+      const int begin=b*kQuantizedBlock;
+      const int count=std::min(cols, begin+kQuantizedBlock)-begin;
+      float scale;
+      std::memcpy(&scale, encoded+b*sizeof(float), sizeof(scale));
+#ifdef VIDEOTRAINER_X86
+      if(HasAvx2()) {
+        DecodeCodesAvx2(codes+begin, scale, count, row+begin);
+        continue;
+      }
+#endif
+      DecodeCodesScalar(codes+begin, scale, count, row+begin);
+    }
+  }
+}
@@ -0,0 +1,45 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  feature_storage.h
+ *
+ *    Description:  Compact row encodings for in-memory feature matrices
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 19시 52분 08초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_FEATURE_STORAGE_H_
+#define VIDEOTRAINER_FEATURE_STORAGE_H_
+
+#include <cstddef>
+#include <string>
+
+enum FeatureStorage {
+  kFloat32Storage,   // 4 bytes per value
+  kFloat16Storage,   // IEEE half, 2 bytes per value
+  kQuantized8Storage // int8 codes with one float scale per block, ~1.1 bytes per value
+};
+
+// Values that share one scale under kQuantized8Storage: a default HOG
+// block (2x2 cells of 9 bins), which is normalised as a unit.
+const int kQuantizedBlock = 36;
+
+bool ParseFeatureStorage(const std::string &name, FeatureStorage &storage);
+const char *FeatureStorageName(FeatureStorage storage);
+
+// Bytes one encoded row of `cols` values takes, padded to 4.
+size_t EncodedRowBytes(FeatureStorage storage, int cols);
+
+// Conversions between a float row and its encoding. Decoding runs in the
+// solver's inner loop, so it uses F16C/AVX2 when the CPU has them.
+void EncodeRow(FeatureStorage storage, const float *row, int cols, unsigned char *encoded);
+void DecodeRow(FeatureStorage storage, const unsigned char *encoded, int cols, float *row);
+
+#endif
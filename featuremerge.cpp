@@ -0,0 +1,170 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  featuremerge.cpp
+ *
+ *    Description:  Merges per-shard feature files from svmtrain --shard
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 12시 47분 55초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <queue>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "feature_shard.h"
+
+struct ShardInput {
+  std::string path;
+  std::ifstream rows;
+  std::vector<ShardRun> runs;
+  size_t next_run;
+};
+
+struct LaterRun {
+  const std::vector< std::unique_ptr<ShardInput> > *inputs;
+  bool operator()(int a, int b) const {
+    return ShardRunBefore((*inputs)[b]->runs[(*inputs)[b]->next_run],
+                          (*inputs)[a]->runs[(*inputs)[a]->next_run]);
+  }
+};
+
+// Copies one feature row, checking its label and dimension against the
+// rest of the merge. Returns false on a malformed or mismatching row.
+bool CopyRow(std::istream &input, std::ostream &output, int expected_label, int &dimension) {
+  std::string line;
+  if(!std::getline(input, line)) return false;
+  const int label=std::atoi(line.c_str());
+  if(expected_label!=0 && label!=expected_label) return false;
+  const int row_dimension=(int)std::count(line.begin(), line.end(), ':');
+  if(dimension<0) dimension=row_dimension;
+  else if(dimension!=row_dimension) return false;
+  output << line << "\n";
+  return true;
+}
+
+int main(int argc, char** argv) {
+  bool concatenate;
+  std::vector<std::string> shard_files;
+  std::string output_file;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("source,s", po::value< std::vector<std::string> >(&shard_files)->required(), "Specify the shard feature files")
+    ("concat,c", po::value<bool>(&concatenate)->default_value(false), "Specify whether to concatenate in the given order instead of merging by video")
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/feature.data"), "Specify an output file");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] shard..." << std::endl;
+      std::cout << desc;
+      std::cout << std::endl << "Local example:" << std::endl
+                << "  for i in 0 1 2 3; do svmtrain -j 4 --shard $i/4 & done; wait" << std::endl
+                << "  " << argv[0] << " -o feature.data feature.data.shard-*-of-4" << std::endl;
+      return 0;
+    }
+
+    po::notify(vm);
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  std::vector< std::unique_ptr<ShardInput> > inputs;
+  for(size_t i=0; i<shard_files.size(); i++) {
+    std::unique_ptr<ShardInput> input(new ShardInput);
+    input->path=shard_files[i];
+    input->rows.open(shard_files[i].c_str());
+    input->next_run=0;
+    if(!input->rows) {
+      std::cerr << "Error opening shard " << shard_files[i] << std::endl;
+      return 1;
+    }
+    if(!concatenate && !LoadShardRuns(shard_files[i], input->runs)) {
+      std::cerr << "Error reading " << ShardRunsFile(shard_files[i]) << ", use --concat 1 to merge without it" << std::endl;
+      return 1;
+    }
+    inputs.push_back(std::move(input));
+  }
+
+  std::ofstream merged(output_file.c_str(), std::ios::out|std::ios::trunc);
+  if(!merged) {
+    std::cerr << "Error opening output file " << output_file << std::endl;
+    return 1;
+  }
+
+  int dimension=-1;
+  long long total_rows=0;
+  if(concatenate) {
+    for(size_t i=0; i<inputs.size(); i++) {
+      while(inputs[i]->rows.peek()!=EOF) {
+        if(!CopyRow(inputs[i]->rows, merged, 0, dimension)) {
+          std::cerr << "Error: malformed row " << total_rows+1 << " in " << inputs[i]->path << std::endl;
+          return 1;
+        }
+        total_rows++;
+      }
+    }
+  } else {
+    // k-way merge on each shard's next video run; the runs inside a shard
+    // are already in global order.
+    LaterRun later_run;
+    later_run.inputs=&inputs;
+    std::priority_queue<int, std::vector<int>, LaterRun> heads(later_run);
+    for(int i=0; i<(int)inputs.size(); i++) {
+      if(!inputs[i]->runs.empty()) heads.push(i);
+    }
+    while(!heads.empty()) {
+      const int i=heads.top();
+      heads.pop();
+      ShardInput &input=*inputs[i];
+      const ShardRun &run=input.runs[input.next_run];
+      for(long long row=0; row<run.rows; row++) {
+        if(!CopyRow(input.rows, merged, run.label, dimension)) {
+          std::cerr << "Error: " << input.path << " does not match its run list at "
+                    << run.video_path << std::endl;
+          return 1;
+        }
+      }
+      total_rows+=run.rows;
+      if(++input.next_run<input.runs.size()) heads.push(i);
+    }
+    for(size_t i=0; i<inputs.size(); i++) {
+      std::string line;
+      if(std::getline(inputs[i]->rows, line)) {
+        std::cerr << "Warning: " << inputs[i]->path << " has rows not covered by its run list" << std::endl;
+      }
+    }
+  }
+
+  std::cout << "Merged " << total_rows << " rows of " << dimension << " features from "
+            << inputs.size() << " shards into " << output_file << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  featurepca.cpp
+ *
+ *    Description:  Fits a block projection for compact HOG rows and maps detectors back
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "block_pca.h"
+#include "detector_io.h"
+#include "feature_file.h"
+
+int main(int argc, char** argv) {
+  int block_values, components, max_samples;
+  std::string output_file;
+  std::string projected_file;
+  std::string projection_file;
+  std::string detector_file;
+  std::string full_detector_file;
+  std::string storage_name;
+  std::vector<std::string> feature_files;
+  FeatureMatrix data;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("source,s", po::value< std::vector<std::string> >(&feature_files), "Specify full HOG feature files to fit the projection on")
+    ("block-values", po::value<int>(&block_values)->default_value(36), "Specify the values per HOG block")
+    ("components,k", po::value<int>(&components)->default_value(12), "Specify the values each block is projected to")
+    ("samples", po::value<int>(&max_samples)->default_value(200000), "Specify the most block vectors to fit on (0 uses all)")
+    ("storage", po::value<std::string>(&storage_name)->default_value("f32"), "Specify how rows are kept in memory: f32, f16 or q8")
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/hog.pca"), "Specify where to write the projection")
+    ("projected", po::value<std::string>(&projected_file), "Specify a feature file to write the projected source rows to")
+    ("projection", po::value<std::string>(&projection_file), "Specify an existing projection to map --detector back with")
+    ("detector,d", po::value<std::string>(&detector_file), "Specify a detector trained on projected rows to map back to full HOG")
+    ("full-detector", po::value<std::string>(&full_detector_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/detector.data"), "Specify where to write the mapped back detector");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] features..." << std::endl;
+      std::cout << "       " << argv[0] << " --projection hog.pca --detector projected.data [--full-detector detector.data]" << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+    if(!ParseFeatureStorage(storage_name, data.storage)) throw std::invalid_argument("unknown storage "+storage_name);
+    if(detector_file.empty() && feature_files.empty()) throw std::invalid_argument("feature files or a detector are required");
+    if(!detector_file.empty() && projection_file.empty()) throw std::invalid_argument("--detector needs --projection");
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  if(!detector_file.empty()) {
+    BlockProjection projection;
+    std::vector<float> projected_detector, detector;
+    if(!LoadBlockProjection(projection_file, projection)) {
+      std::cerr << "Error opening projection " << projection_file << std::endl;
+      return 1;
+    }
+    if(!LoadDetector(detector_file, projected_detector) || !BackProjectDetector(projection, projected_detector, detector)) {
+      std::cerr << "Error: " << detector_file << " is not a detector over " << projection.components << "-value blocks" << std::endl;
+      return 1;
+    }
+    if(!SaveDetector(full_detector_file, detector)) {
+      std::cerr << "Error writing detector " << full_detector_file << std::endl;
+      return 1;
+    }
+    std::cout << "Mapped " << projected_detector.size()-1 << " weights back to " << detector.size()-1
+              << " in " << full_detector_file << std::endl;
+    return 0;
+  }
+
+  for(size_t i=0; i<feature_files.size(); i++) {
+    if(!ReadFeatureFile(feature_files[i], data)) {
+      std::cerr << "Error reading feature file " << feature_files[i] << std::endl;
+      return 1;
+    }
+  }
+
+  BlockProjection projection;
+  std::vector<double> explained;
+  if(!FitBlockProjection(data, block_values, components, max_samples, projection, &explained)) {
+    std::cerr << "Error: " << data.cols << " features are not blocks of " << block_values
+              << " values, or " << components << " components do not fit" << std::endl;
+    return 1;
+  }
+  if(!SaveBlockProjection(output_file, projection)) {
+    std::cerr << "Error writing projection " << output_file << std::endl;
+    return 1;
+  }
+
+  // How much block variance each choice of k keeps, to trade accuracy
+  // against row size and per-window scoring cost.
+  const int blocks=data.cols/block_values;
+  std::cout << "components\tvalues_per_row\tvariance_kept" << std::endl;
+  for(size_t k=0; k<explained.size(); k++) {
+    std::cout << k+1 << "\t" << (k+1)*blocks << "\t" << explained[k]
+              << ((int)k+1==components ? "\t<-" : "") << std::endl;
+  }
+  std::cout << "Projection written to " << output_file << ": rows shrink from " << data.cols << " to "
+            << blocks*components << " values (" << (double)block_values/components << "x)" << std::endl;
+
+  if(!projected_file.empty()) {
+    FeatureMatrix projected;
+    projected.rows=data.rows;
+    projected.cols=blocks*components;
+    projected.values.resize((size_t)projected.rows*projected.cols);
+    projected.labels=data.labels;
+    std::vector<float> scratch(data.cols);
+    std::vector<int> rows(data.rows);
+    for(int i=0; i<data.rows; i++) {
+      ProjectBlocks(projection, data.row(i, scratch.data()), blocks, projected.row(i));
+      rows[i]=i;
+    }
+    std::ofstream output(projected_file.c_str(), std::ios::out|std::ios::trunc);
+    WriteFeatureRows(output, projected, rows);
+    std::cout << "Projected rows written to " << projected_file << std::endl;
+  }
+  return 0;
+}
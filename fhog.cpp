@@ -0,0 +1,166 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  fhog.cpp
+ *
+ *    Description:  Felzenszwalb's 31-value-per-cell HOG variant
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "fhog.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kOrientations = 9;
+const float kEpsilon = 0.0001f;
+const float kTruncation = 0.2f;
+const float kEnergyScale = 0.2357f;
+
+// Unit vectors of the 9 orientations 20 degrees apart; a gradient is
+// snapped to the closest one or its opposite.
+const float kUx[kOrientations] = {1.0000f, 0.9397f, 0.7660f, 0.5000f, 0.1736f, -0.1736f, -0.5000f, -0.7660f, -0.9397f};
+const float kUy[kOrientations] = {0.0000f, 0.3420f, 0.6428f, 0.8660f, 0.9848f, 0.9848f, 0.8660f, 0.6428f, 0.3420f};
+
+}
+
+void ComputeFhogMap(const cv::Mat &gray, int cell_size, FhogMap &map) {
+  const int cells_x=gray.cols/cell_size;
+  const int cells_y=gray.rows/cell_size;
+  map.cells_x=std::max(cells_x-2, 0);
+  map.cells_y=std::max(cells_y-2, 0);
+  map.values.assign((size_t)map.cells_x*map.cells_y*kFhogCellValues, 0.f);
+  if(map.cells_x==0 || map.cells_y==0) return;
+
+  // Orientation histograms with each pixel spread bilinearly over the four
+  // nearest cell centres.
+  std::vector<float> histogram((size_t)cells_x*cells_y*2*kOrientations, 0.f);
+  const int visible_x=cells_x*cell_size;
+  const int visible_y=cells_y*cell_size;
+  for(int y=1; y<visible_y-1; y++) {
+    const unsigned char *above=gray.ptr<unsigned char>(y-1);
+    const unsigned char *row=gray.ptr<unsigned char>(y);
+    const unsigned char *below=gray.ptr<unsigned char>(y+1);
+    const float yp=(y+0.5f)/cell_size-0.5f;
+    const int iy=(int)std::floor(yp);
+    const float vy0=yp-iy;
+    const float vy1=1.f-vy0;
+    for(int x=1; x<visible_x-1; x++) {
+      const float dx=(float)row[x+1]-row[x-1];
+      const float dy=(float)below[x]-above[x];
+      const float magnitude=std::sqrt(dx*dx+dy*dy);
+
+      float best=0.f;
+      int orientation=0;
+      for(int o=0; o<kOrientations; o++) {
+        const float dot=kUx[o]*dx+kUy[o]*dy;
+        if(dot>best) {
+          best=dot;
+          orientation=o;
+        } else if(-dot>best) {
+          best=-dot;
+          orientation=o+kOrientations;
+        }
+      }
+
+      const float xp=(x+0.5f)/cell_size-0.5f;
+      const int ix=(int)std::floor(xp);
+      const float vx0=xp-ix;
+      const float vx1=1.f-vx0;
+      if(ix>=0 && iy>=0) histogram[((size_t)iy*cells_x+ix)*2*kOrientations+orientation]+=vx1*vy1*magnitude;
+      if(ix+1<cells_x && iy>=0) histogram[((size_t)iy*cells_x+ix+1)*2*kOrientations+orientation]+=vx0*vy1*magnitude;
+      if(ix>=0 && iy+1<cells_y) histogram[((size_t)(iy+1)*cells_x+ix)*2*kOrientations+orientation]+=vx1*vy0*magnitude;
+      if(ix+1<cells_x && iy+1<cells_y) histogram[((size_t)(iy+1)*cells_x+ix+1)*2*kOrientations+orientation]+=vx0*vy0*magnitude;
+    }
+  }
+
+  // Energy of each cell's contrast-insensitive histogram.
+  std::vector<float> energy((size_t)cells_x*cells_y, 0.f);
+  for(int c=0; c<cells_x*cells_y; c++) {
+    const float *h=&histogram[(size_t)c*2*kOrientations];
+    for(int o=0; o<kOrientations; o++) energy[c]+=(h[o]+h[o+kOrientations])*(h[o]+h[o+kOrientations]);
+  }
+
+  for(int y=0; y<map.cells_y; y++) {
+    for(int x=0; x<map.cells_x; x++) {
+      // Cell (x+1, y+1) of the image against the 2x2 blocks reaching
+      // right-down, right-up, left-down and left-up.
+      const int cx=x+1, cy=y+1;
+      const float *e=&energy[0];
+      float norm[4];
+      norm[0]=1.f/std::sqrt(e[cy*cells_x+cx]+e[cy*cells_x+cx+1]+e[(cy+1)*cells_x+cx]+e[(cy+1)*cells_x+cx+1]+kEpsilon);
+      norm[1]=1.f/std::sqrt(e[cy*cells_x+cx]+e[cy*cells_x+cx+1]+e[(cy-1)*cells_x+cx]+e[(cy-1)*cells_x+cx+1]+kEpsilon);
+      norm[2]=1.f/std::sqrt(e[cy*cells_x+cx]+e[cy*cells_x+cx-1]+e[(cy+1)*cells_x+cx]+e[(cy+1)*cells_x+cx-1]+kEpsilon);
+      norm[3]=1.f/std::sqrt(e[cy*cells_x+cx]+e[cy*cells_x+cx-1]+e[(cy-1)*cells_x+cx]+e[(cy-1)*cells_x+cx-1]+kEpsilon);
+
+      const float *h=&histogram[((size_t)cy*cells_x+cx)*2*kOrientations];
+      float *out=&map.values[((size_t)y*map.cells_x+x)*kFhogCellValues];
+      float texture[4]={0.f, 0.f, 0.f, 0.f};
+      for(int o=0; o<2*kOrientations; o++) {
+        float sum=0.f;
+        for(int n=0; n<4; n++) {
+          const float value=std::min(h[o]*norm[n], kTruncation);
+          sum+=value;
+          texture[n]+=value;
+        }
+        out[o]=0.5f*sum;
+      }
+      for(int o=0; o<kOrientations; o++) {
+        float sum=0.f;
+        for(int n=0; n<4; n++) sum+=std::min((h[o]+h[o+kOrientations])*norm[n], kTruncation);
+        out[2*kOrientations+o]=0.5f*sum;
+      }
+      for(int n=0; n<4; n++) out[3*kOrientations+n]=kEnergyScale*texture[n];
+    }
+  }
+}
+
+void ComputeFhogDescriptor(const cv::Mat &window, int cell_size, std::vector<float> &descriptor) {
+  cv::Mat gray;
+  if(window.channels()==1) gray=window;
+  else cv::cvtColor(window, gray, cv::COLOR_BGR2GRAY);
+  FhogMap map;
+  ComputeFhogMap(gray, cell_size, map);
+  descriptor.swap(map.values);
+}
+
+int FhogDescriptorSize(const cv::Size &window_size, int cell_size) {
+  const int cells_x=window_size.width/cell_size-2;
+  const int cells_y=window_size.height/cell_size-2;
+  return (cells_x>0 && cells_y>0 ? cells_x*cells_y*kFhogCellValues : 0);
+}
+
+bool BuildFhogFlipTable(const cv::Size &window_size, int cell_size, std::vector<int> &table) {
+  table.clear();
+  if(cell_size<=0 || window_size.width%cell_size || FhogDescriptorSize(window_size, cell_size)==0) return false;
+  const int cells_x=window_size.width/cell_size-2;
+  const int cells_y=window_size.height/cell_size-2;
+
+  // Mirroring negates dx: orientation o (o*20 degrees) becomes 9-o, and
+  // the right-down/right-up blocks trade places with left-down/left-up.
+  int mirrored[kFhogCellValues];
+  for(int o=0; o<2*kOrientations; o++) mirrored[o]=(2*kOrientations+kOrientations-o)%(2*kOrientations);
+  for(int o=0; o<kOrientations; o++) mirrored[2*kOrientations+o]=2*kOrientations+(kOrientations-o)%kOrientations;
+  const int energy_swap[4]={2, 3, 0, 1};
+  for(int n=0; n<4; n++) mirrored[3*kOrientations+n]=3*kOrientations+energy_swap[n];
+
+  table.resize((size_t)cells_x*cells_y*kFhogCellValues);
+  for(int y=0; y<cells_y; y++) {
+    for(int x=0; x<cells_x; x++) {
+      const int cell=(y*cells_x+x)*kFhogCellValues;
+      const int source_cell=(y*cells_x+cells_x-1-x)*kFhogCellValues;
+      for(int v=0; v<kFhogCellValues; v++) table[cell+v]=source_cell+mirrored[v];
+    }
+  }
+  return true;
+}
@@ -0,0 +1,59 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  fhog.h
+ *
+ *    Description:  Felzenszwalb's 31-value-per-cell HOG variant
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 20시 31분 16초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_FHOG_H_
+#define VIDEOTRAINER_FHOG_H_
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// Per cell: 18 contrast-sensitive orientations, 9 insensitive ones and 4
+// gradient energies, each normalised against the four 2x2-cell blocks the
+// cell belongs to (Felzenszwalb et al., PAMI 2010). The cell features are
+// analytic projections of the 4x36 block values standard HOG stores.
+const int kFhogCellValues = 31;
+
+// Features of every cell that has all eight neighbours, i.e. every cell of
+// the image but the outer ring, cells_x*cells_y of them in row-major order.
+struct FhogMap {
+  int cells_x;
+  int cells_y;
+  std::vector<float> values;
+
+  const float *cell(int x, int y) const { return &values[((size_t)y*cells_x+x)*kFhogCellValues]; }
+};
+
+// `gray` is 8-bit single channel; cell_size is in pixels.
+void ComputeFhogMap(const cv::Mat &gray, int cell_size, FhogMap &map);
+
+// The map of one window, flattened: window.width/cell_size-2 by
+// window.height/cell_size-2 cells. A window placed at a cell boundary of a
+// frame reads the same cells from the frame's map, which is how detection
+// scores it. Colour windows are converted to gray first.
+void ComputeFhogDescriptor(const cv::Mat &window, int cell_size, std::vector<float> &descriptor);
+
+int FhogDescriptorSize(const cv::Size &window_size, int cell_size);
+
+// Mirror permutation of a window descriptor for FlipHogDescriptor (see
+// hog_flip.h): cell columns reverse, orientation theta becomes 180-theta
+// and the left and right normalisation blocks of the energies swap. Only
+// gradients exactly between two orientations (dx==0) snap differently from
+// a re-extracted mirrored window.
+bool BuildFhogFlipTable(const cv::Size &window_size, int cell_size, std::vector<int> &table);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  frame_pool.cpp
+ *
+ *    Description:  Preallocated frame buffers reused across capture reads
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 08분 41초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "frame_pool.h"
+
+FramePool::FramePool(int capacity) : frames_(capacity>0 ? capacity : 1) {
+  for(int i=(int)frames_.size()-1; i>=0; i--) free_.push_back(i);
+}
+
+int FramePool::Acquire() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  available_.wait(lock, [this] { return !free_.empty(); });
+  const int slot=free_.back();
+  free_.pop_back();
+  return slot;
+}
+
+void FramePool::Release(int slot) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_.push_back(slot);
+  }
+  available_.notify_one();
+}
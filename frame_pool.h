@@ -0,0 +1,50 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  frame_pool.h
+ *
+ *    Description:  Preallocated frame buffers reused across capture reads
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 08분 41초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_FRAME_POOL_H_
+#define VIDEOTRAINER_FRAME_POOL_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// Fixed set of frame buffers. A slot is owned by one reader between
+// Acquire() and Release() and no other Mat header points at its storage,
+// so once the first frame has settled its size and type every later read
+// decodes straight into the same allocation.
+class FramePool {
+ public:
+  explicit FramePool(int capacity=2);
+
+  int capacity() const { return (int)frames_.size(); }
+
+  // Blocks until a slot is free and returns its index.
+  int Acquire();
+  void Release(int slot);
+
+  cv::Mat &frame(int slot) { return frames_[slot]; }
+
+ private:
+  std::vector<cv::Mat> frames_;
+  std::vector<int> free_;
+  std::mutex mutex_;
+  std::condition_variable available_;
+};
+
+#endif
@@ -29,15 +29,18 @@
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
 
+#include "feature_file.h"
+#include "video_scheduler.h"
+#include "window_reservoir.h"
+
 typedef std::vector<float> Features;
 
 void ComputeFeatures(const cv::Mat & image,
                      Features & features,
-                     const cv::Size & size) {
-  cv::HOGDescriptor hog;
-  hog.winSize = size;
+                     const cv::HOGDescriptor & hog) {
   cv::Mat gray;
-  cv::cvtColor( image, gray, cv::COLOR_BGR2GRAY );
+  if(image.channels()==1) gray=image;
+  else cv::cvtColor( image, gray, cv::COLOR_BGR2GRAY );
   hog.compute( gray, features, cv::Size(8,8), cv::Size(0,0) );
 }
 
@@ -56,43 +59,137 @@ void BuildPyramid(const cv::Mat & image,
   }
 }
 
+// Octave levels of a frame that still hold a whole window, the frame
+// itself being level 0.
+int CountPyramidLevels(const cv::Size & image_size,
+                       const cv::Size & min_size) {
+  int levels=0;
+  while((image_size.width>>levels)>=min_size.width && (image_size.height>>levels)>=min_size.height) levels++;
+  return levels;
+}
+
+// Window positions of ApplySlidingWindow: at most max_*_steps windows per
+// row and column, spread evenly and never crossing the image border.
+void SlidingWindowBoxes(const cv::Size & image_size,
+                        std::vector<cv::Rect> & boxes,
+                        const cv::Size & window_size,
+                        const unsigned int max_horizontal_steps,
+                        const unsigned int max_vertical_steps) {
+  const int horizontal_padding=std::max(image_size.width/std::max((int)max_horizontal_steps,1)-window_size.width,0);
+  const int vertical_padding=std::max(image_size.height/std::max((int)max_vertical_steps,1)-window_size.height,0);
+
+  cv::Rect box;
+  box.width=window_size.width;
+  box.height=window_size.height;
+  for(box.y=0; box.y+box.height<=image_size.height; box.y+=(vertical_padding+window_size.height)) {
+    for(box.x=0; box.x+box.width<=image_size.width; box.x+=(horizontal_padding+window_size.width)) {
+      boxes.push_back(box);
+    }
+  }
+}
+
+// Offers `box` (in frame coordinates) to the reservoir and copies the
+// window out only if it is admitted.
+void OfferWindow(WindowReservoir & reservoir,
+                 const cv::Mat & frame,
+                 int frame_index,
+                 int level,
+                 const cv::Rect & box,
+                 const cv::Size & window_size) {
+  WindowSample * slot=reservoir.Admit(frame_index, level, box);
+  if(!slot) return;
+  cv::resize(frame(box), slot->pixels, window_size, 0, 0, cv::INTER_AREA);
+}
+
+// One candidate per frame: the whole frame when `scale` is set, otherwise
+// a random window of it.
 void ExtractFeaturesFromEachFrame(const std::string & video_source,
-                                  std::vector<Features> features_collection,
+                                  int video_index,
+                                  WindowReservoir & reservoir,
                                   const cv::Size & window_size,
                                   bool scale) {
-  std::srand(std::time(0));
-
-  cv::VideoCapture video(video_source);
-  if(!video.isOpened()) return;
-
-  cv::HOGDescriptor hog;
-  hog.winSize=window_size;
+  VideoSegment whole_video;
+  whole_video.video_index=video_index;
+  whole_video.begin_frame=0;
+  whole_video.end_frame=-1;
+  whole_video.step=1;
 
-  cv::Mat frame;
-  cv::Mat extracted_frame;
-  Features features;
-  while(video.read(frame)) {
-    if(scale) cv::resize(frame, extracted_frame, window_size);
-    else {
+  reservoir.BeginVideo(video_index, 1);
+  ReadVideoSegment(video_source, whole_video, [&](const cv::Mat & frame, int frame_index) {
+    if(frame.cols<window_size.width || frame.rows<window_size.height) return;
+    cv::Rect patch(0, 0, frame.cols, frame.rows);
+    if(!scale) {
       // Extract frame
-      cv::Rect patch;
       patch.width=window_size.width;
       patch.height=window_size.height;
-      patch.x=std::rand()%(frame.cols-window_size.width);
-      patch.y=std::rand()%(frame.rows-window_size.height);
-      extracted_frame=((frame)(patch)).clone();
-
-      features_collection.push_back(Features((features_collection.size()==0?0:features_collection.front().size())));
-      ComputeFeatures(extracted_frame, features_collection.back(), window_size);
+      patch.x=std::rand()%(frame.cols-window_size.width+1);
+      patch.y=std::rand()%(frame.rows-window_size.height+1);
     }
-    features.clear();
-  }
+    OfferWindow(reservoir, frame, frame_index, 0, patch, window_size);
+  }, kLumaFrames);
+  reservoir.EndVideo();
 }
 
+// Every sliding window of every octave is a candidate, stratified by
+// octave. Windows are not cut out, let alone scaled, unless admitted.
 void ExtractFeaturesFromEachWindow(const std::string & video_source,
-                                   std::vector<Features> features_collection,
+                                   int video_index,
+                                   WindowReservoir & reservoir,
                                    const cv::Size & window_size,
-                                   bool scale) {
+                                   const unsigned int max_horizontal_steps,
+                                   const unsigned int max_vertical_steps) {
+  VideoSegment whole_video;
+  whole_video.video_index=video_index;
+  whole_video.begin_frame=0;
+  whole_video.end_frame=-1;
+  whole_video.step=1;
+
+  bool started=false;
+  cv::Size frame_size;
+  std::vector<std::vector<cv::Rect> > level_boxes;
+  ReadVideoSegment(video_source, whole_video, [&](const cv::Mat & frame, int frame_index) {
+    if(!started) {
+      // The window grid only depends on the frame size, fixed per video.
+      frame_size=frame.size();
+      level_boxes.resize(std::max(CountPyramidLevels(frame_size, window_size),1));
+      for(size_t level=0; level<level_boxes.size(); level++) {
+        const cv::Size level_size(frame_size.width>>level, frame_size.height>>level);
+        SlidingWindowBoxes(level_size, level_boxes[level], window_size, max_horizontal_steps, max_vertical_steps);
+        for(size_t i=0; i<level_boxes[level].size(); i++) {
+          cv::Rect & box=level_boxes[level][i];
+          box=cv::Rect(box.x<<level, box.y<<level, box.width<<level, box.height<<level);
+        }
+      }
+      reservoir.BeginVideo(video_index, (int)level_boxes.size());
+      started=true;
+    }
+    if(frame.size()!=frame_size) return;
+    for(size_t level=0; level<level_boxes.size(); level++) {
+      for(size_t i=0; i<level_boxes[level].size(); i++) {
+        OfferWindow(reservoir, frame, frame_index, (int)level, level_boxes[level][i], window_size);
+      }
+    }
+  }, kLumaFrames);
+  if(started) reservoir.EndVideo();
+}
+
+// HOG runs here once per window left in the reservoir, not per candidate.
+// Rows are appended to `data` under `label`.
+void ComputeReservoirFeatures(const WindowReservoir & reservoir,
+                              float label,
+                              FeatureMatrix & data,
+                              const cv::HOGDescriptor & hog) {
+  std::vector<WindowSample> samples;
+  reservoir.Collect(samples);
+  Features features;
+  for(size_t i=0; i<samples.size(); i++) {
+    ComputeFeatures(samples[i].pixels, features, hog);
+    if(data.rows==0) data.cols=(int)features.size();
+    if((int)features.size()!=data.cols) continue;
+    data.values.insert(data.values.end(), features.begin(), features.end());
+    data.labels.push_back(label);
+    data.rows++;
+  }
 }
 
 void ApplySlidingWindow(const cv::Mat & image,
@@ -101,31 +198,21 @@ void ApplySlidingWindow(const cv::Mat & image,
                         const cv::Size & window_size,
                         const unsigned int max_horizontal_steps,
                         const unsigned int max_vertical_steps) {
-  const unsigned int horizontal_padding=std::max(image.cols/std::max((int)max_horizontal_steps,1)-window_size.width,0);
-  const unsigned int vertical_padding=std::max(image.rows/std::max((int)max_vertical_steps,1)-window_size.height,0);
+  std::vector<cv::Rect> boxes;
+  SlidingWindowBoxes(image.size(), boxes, window_size, max_horizontal_steps, max_vertical_steps);
 
-  cv::Rect box;
-  box.width=window_size.width;
-  box.height=window_size.height;
   cv::Mat sliding_window;
-  int x=0,y=0;
-  while(y<image.rows) {
-    while(x<image.cols) {
-      box.x=x;
-      box.y=y;
-      sliding_window=(image)(box);
-      if(detect_func(sliding_window)) windows.push_back(sliding_window.clone());
-      x+=(horizontal_padding+window_size.width);
-    }
-
-    x=0;
-    y+=(vertical_padding+window_size.height);
+  for(size_t i=0; i<boxes.size(); i++) {
+    sliding_window=(image)(boxes[i]);
+    if(detect_func(sliding_window)) windows.push_back(sliding_window.clone());
   }
 }
 
 int main( int argc, char** argv ) {
   bool test_only;
   int width, height, video_source;
+  int positive_windows, negative_windows;
+  unsigned int max_horizontal_steps, max_vertical_steps, seed;
   std::string output_file;
   std::string positive_source_directory;
   std::string negative_source_directory;
@@ -142,7 +229,12 @@ int main( int argc, char** argv ) {
     ("height,h", po::value<int>(&height)->default_value(128), "Specify train window height")
     ("positive,p", po::value<std::string>(&positive_source_directory)->default_value(current_path+"/positive"), "Specify positive video files directory")
     ("negative,n", po::value<std::string>(&negative_source_directory)->default_value(current_path+"/negative"), "Specify negative video files direcotry")
-    ("output,o", po::value<std::string>(&output_file)->default_value(current_path+"/feature.data"), "Specify an output file");
+    ("output,o", po::value<std::string>(&output_file)->default_value(current_path+"/feature.data"), "Specify an output file")
+    ("positive-windows", po::value<int>(&positive_windows)->default_value(5000), "Specify how many positive windows to keep, however long the videos")
+    ("negative-windows", po::value<int>(&negative_windows)->default_value(20000), "Specify how many negative windows to keep, however long the videos")
+    ("steps-x", po::value<unsigned int>(&max_horizontal_steps)->default_value(8), "Specify the most negative windows per row of a frame")
+    ("steps-y", po::value<unsigned int>(&max_vertical_steps)->default_value(8), "Specify the most negative windows per column of a frame")
+    ("seed", po::value<unsigned int>(&seed)->default_value(0), "Specify the sampling seed (0 uses the clock)");
 
     po::variables_map vm;
     po::store(po::command_line_parser(argc,argv).options(desc).run(), vm);
@@ -166,8 +258,45 @@ int main( int argc, char** argv ) {
   const cv::Size win_size(width,height);
 
   if(!test_only) {
-    std::vector<Features> positive_features_collection;
-    std::vector<Features> negative_features_collection;
+    if(seed==0) seed=(unsigned int)std::time(0);
+    std::srand(seed);
+    cv::HOGDescriptor hog;
+    hog.winSize=win_size;
+
+    // Positive clips are framed on the object, so each frame is one
+    // window; negatives offer every sliding window of every octave.
+    std::vector<std::string> positive_videos, negative_videos;
+    ListVideoFiles(positive_source_directory, positive_videos);
+    ListVideoFiles(negative_source_directory, negative_videos);
+
+    WindowReservoir positive_reservoir(positive_windows, (int)positive_videos.size(), seed);
+    for(size_t i=0; i<positive_videos.size(); i++) {
+      std::cout << "Sampling " << positive_videos[i] << std::endl;
+      ExtractFeaturesFromEachFrame(positive_videos[i], (int)i, positive_reservoir, win_size, true);
+    }
+    WindowReservoir negative_reservoir(negative_windows, (int)negative_videos.size(), seed+1);
+    for(size_t i=0; i<negative_videos.size(); i++) {
+      std::cout << "Sampling " << negative_videos[i] << std::endl;
+      ExtractFeaturesFromEachWindow(negative_videos[i], (int)i, negative_reservoir, win_size,
+                                    max_horizontal_steps, max_vertical_steps);
+    }
+
+    FeatureMatrix data;
+    ComputeReservoirFeatures(positive_reservoir, +1, data, hog);
+    const int positive_rows=data.rows;
+    ComputeReservoirFeatures(negative_reservoir, -1, data, hog);
+    std::cout << "Kept " << positive_rows << " of " << positive_reservoir.offered()
+              << " positive and " << data.rows-positive_rows << " of " << negative_reservoir.offered()
+              << " negative windows" << std::endl;
+
+    std::vector<int> rows(data.rows);
+    for(int i=0; i<data.rows; i++) rows[i]=i;
+    std::ofstream feature_data(output_file.c_str());
+    WriteFeatureRows(feature_data, data, rows);
+    if(!feature_data) {
+      std::cerr << "Error writing " << output_file << std::endl;
+      return 1;
+    }
   }
 
   // std::cout << "Testing..." << std::endl;
@@ -0,0 +1,103 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  hog_flip.cpp
+ *
+ *    Description:  Horizontal-flip augmentation of HOG descriptors in feature space
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 37분 52초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "hog_flip.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VIDEOTRAINER_X86 1
+#endif
+
+namespace {
+
+void FlipScalar(const float *descriptor, float *flipped, const int *table, int begin, int count) {
+  for(int i=begin; i<count; i++) flipped[i]=descriptor[table[i]];
+}
+
+#ifdef VIDEOTRAINER_X86
+
+// The table is an arbitrary permutation, which g++ does not vectorise as a
+// plain loop; AVX2 gathers eight values per instruction.
+__attribute__((target("avx2")))
+void FlipAvx2(const float *descriptor, float *flipped, const int *table, int count) {
+  int i=0;
+  for(; i+8<=count; i+=8) {
+    const __m256i index=_mm256_loadu_si256((const __m256i *)(table+i));
+    _mm256_storeu_ps(flipped+i, _mm256_i32gather_ps(descriptor, index, 4));
+  }
+  FlipScalar(descriptor, flipped, table, i, count);
+}
+
+bool HasAvx2() {
+  static const bool supported=__builtin_cpu_supports("avx2");
+  return supported;
+}
+
+#endif
+
+}
+
+bool BuildHogFlipTable(const cv::HOGDescriptor &hog, std::vector<int> &table) {
+  table.clear();
+  const int nbins=hog.nbins;
+  if(nbins<=0 || hog.cellSize.width<=0 || hog.cellSize.height<=0
+     || hog.blockStride.width<=0 || hog.blockStride.height<=0) return false;
+  if(hog.blockSize.width%hog.cellSize.width || hog.blockSize.height%hog.cellSize.height) return false;
+  if((hog.winSize.width-hog.blockSize.width)%hog.blockStride.width
+     || (hog.winSize.height-hog.blockSize.height)%hog.blockStride.height) return false;
+  if(hog.signedGradient && nbins%2) return false;
+
+  // Same order as HOGDescriptor::compute: blocks column-major (x outer),
+  // cells inside a block column-major, bins innermost.
+  const int blocks_x=(hog.winSize.width-hog.blockSize.width)/hog.blockStride.width+1;
+  const int blocks_y=(hog.winSize.height-hog.blockSize.height)/hog.blockStride.height+1;
+  const int cells_x=hog.blockSize.width/hog.cellSize.width;
+  const int cells_y=hog.blockSize.height/hog.cellSize.height;
+  const int block_values=cells_x*cells_y*nbins;
+
+  std::vector<int> mirrored_bin(nbins);
+  for(int bin=0; bin<nbins; bin++) {
+    mirrored_bin[bin]=(hog.signedGradient ? (nbins/2-1-bin+nbins)%nbins : nbins-1-bin);
+  }
+
+  table.resize((size_t)blocks_x*blocks_y*block_values);
+  for(int bx=0; bx<blocks_x; bx++) {
+    for(int by=0; by<blocks_y; by++) {
+      const int block=(bx*blocks_y+by)*block_values;
+      const int source_block=((blocks_x-1-bx)*blocks_y+by)*block_values;
+      for(int cx=0; cx<cells_x; cx++) {
+        for(int cy=0; cy<cells_y; cy++) {
+          const int cell=block+(cx*cells_y+cy)*nbins;
+          const int source_cell=source_block+((cells_x-1-cx)*cells_y+cy)*nbins;
+          for(int bin=0; bin<nbins; bin++) table[cell+bin]=source_cell+mirrored_bin[bin];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void FlipHogDescriptor(const float *descriptor, float *flipped, const std::vector<int> &table) {
+  const int count=(int)table.size();
+#ifdef VIDEOTRAINER_X86
+  if(HasAvx2()) {
+    FlipAvx2(descriptor, flipped, table.data(), count);
+    return;
+  }
+#endif
+  FlipScalar(descriptor, flipped, table.data(), 0, count);
+}
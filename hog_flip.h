@@ -0,0 +1,40 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  hog_flip.h
+ *
+ *    Description:  Horizontal-flip augmentation of HOG descriptors in feature space
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 37분 52초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_HOG_FLIP_H_
+#define VIDEOTRAINER_HOG_FLIP_H_
+
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// The HOG of a mirrored window is a permutation of the original: block
+// column bx becomes nbx-1-bx, cell column cx inside a block becomes
+// ncx-1-cx, and an orientation theta becomes 180-theta, which maps
+// unsigned bin b to nbins-1-b (signed bins b to nbins/2-1-b mod nbins).
+// Block normalisation and the Gaussian block window are symmetric, so only
+// gradients at the window border differ from re-extracting a flipped
+// frame.
+//
+// Builds table[i] = index of the original value that lands at i. Returns
+// false for geometries that are not mirror symmetric.
+bool BuildHogFlipTable(const cv::HOGDescriptor &hog, std::vector<int> &table);
+
+// flipped[i] = descriptor[table[i]]; the buffers must not overlap.
+void FlipHogDescriptor(const float *descriptor, float *flipped, const std::vector<int> &table);
+
+#endif
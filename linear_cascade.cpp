@@ -0,0 +1,334 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  linear_cascade.cpp
+ *
+ *    Description:  Early-rejection cascade over the blocks of a linear HOG detector
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 19시 20분 44초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "linear_cascade.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "block_pca.h"
+#include "linear_svm.h"
+
+namespace {
+
+const char *kCascadeHeader = "# videotrainer cascade v1";
+
+double BlockTerm(const float *weights, const float *values, int count) {
+  double sum=0.0;
+  for(int k=0; k<count; k++) sum+=(double)weights[k]*values[k];
+  return sum;
+}
+
+struct HigherContribution {
+  const std::vector<double> *contribution;
+  bool operator()(int a, int b) const {
+    if((*contribution)[a]!=(*contribution)[b]) return (*contribution)[a]>(*contribution)[b];
+    return a<b;
+  }
+};
+
+// Scans every window of one pyramid level.
+class CascadeLevel : public cv::ParallelLoopBody {
+ public:
+  CascadeLevel(const LinearCascade &cascade, const cv::Mat &image, const std::vector<double> &scales,
+               std::vector< std::vector<ScoredDetection> > &found, std::vector<CascadeCounters> &counters)
+    : cascade_(cascade), image_(image), scales_(scales), found_(found), counters_(counters) {}
+
+  void operator()(const cv::Range &range) const {
+    for(int level=range.start; level<range.end; level++) Scan(level);
+  }
+
+ private:
+  void Scan(int level) const {
+    const double scale=scales_[level];
+    const cv::Size size((int)std::round(image_.cols/scale), (int)std::round(image_.rows/scale));
+    cv::Mat resized;
+    if(scale==1.0) resized=image_;
+    else cv::resize(image_, resized, size);
+
+    cv::HOGDescriptor hog(cascade_.window_size, cascade_.block_size, cascade_.block_stride, cascade_.cell_size, cascade_.nbins);
+    BlockGrid grid;
+    ComputeBlockGrid(hog, resized, grid);
+
+    const int block_values=cascade_.block_values();
+    const int grid_x=grid.blocks_x;
+    const int grid_y=grid.blocks_y;
+    const int blocks_x=cascade_.blocks_x();
+    const int blocks_y=cascade_.blocks_y();
+    if(grid_x<blocks_x || grid_y<blocks_y) return;
+
+    // Offsets of each stage's blocks in the grid, relative to the window origin.
+    std::vector<int> offsets, weights, stage_end;
+    for(size_t s=0; s<cascade_.stages.size(); s++) {
+      const std::vector<int> &blocks=cascade_.stages[s].blocks;
+      for(size_t i=0; i<blocks.size(); i++) {
+        const int bx=blocks[i]/blocks_y;
+        const int by=blocks[i]%blocks_y;
+        offsets.push_back((by*grid_x+bx)*block_values);
+        weights.push_back(blocks[i]*block_values);
+      }
+      stage_end.push_back((int)offsets.size());
+    }
+
+    const float bias=cascade_.detector.back();
+    CascadeCounters &counters=counters_[level];
+    std::vector<ScoredDetection> &found=found_[level];
+    for(int wy=0; wy+blocks_y<=grid_y; wy++) {
+      for(int wx=0; wx+blocks_x<=grid_x; wx++) {
+        const float *origin=grid.block(wx, wy);
+        double score=bias;
+        bool rejected=false;
+        int term=0;
+        for(size_t s=0; s<stage_end.size() && !rejected; s++) {
+          for(; term<stage_end[s]; term++) {
+            score+=BlockTerm(&cascade_.detector[weights[term]], origin+offsets[term], block_values);
+          }
+          rejected=(score<cascade_.stages[s].threshold);
+        }
+        counters.windows++;
+        counters.blocks+=term;
+        if(rejected) continue;
+
+        ScoredDetection detection;
+        detection.box=cv::Rect((int)std::round(wx*cascade_.block_stride.width*scale),
+                               (int)std::round(wy*cascade_.block_stride.height*scale),
+                               (int)std::round(cascade_.window_size.width*scale),
+                               (int)std::round(cascade_.window_size.height*scale));
+        detection.score=score;
+        found.push_back(detection);
+      }
+    }
+  }
+
+  const LinearCascade &cascade_;
+  const cv::Mat &image_;
+  const std::vector<double> &scales_;
+  std::vector< std::vector<ScoredDetection> > &found_;
+  std::vector<CascadeCounters> &counters_;
+};
+
+}
+
+bool BuildCascade(const FeatureMatrix &data, const std::vector<float> &detector,
+                  const cv::HOGDescriptor &hog, const std::vector<double> &stage_fractions,
+                  double recall, LinearCascade &cascade,
+                  std::vector<CascadeStageReport> *report) {
+  cascade.window_size=hog.winSize;
+  cascade.block_size=hog.blockSize;
+  cascade.block_stride=hog.blockStride;
+  cascade.cell_size=hog.cellSize;
+  cascade.nbins=hog.nbins;
+  cascade.detector=detector;
+  cascade.stages.clear();
+
+  const int block_values=cascade.block_values();
+  const int block_count=cascade.blocks_x()*cascade.blocks_y();
+  if(data.cols!=block_count*block_values || (int)detector.size()!=data.cols+1) {
+    std::cerr << "Error: " << data.cols << " features and a detector of " << detector.size()
+              << " values do not match " << block_count << " blocks of " << block_values << std::endl;
+    return false;
+  }
+
+  // terms[i*block_count+b] = w_b.x_b of row i.
+  std::vector<float> terms((size_t)data.rows*block_count);
+  std::vector<double> contribution(block_count, 0.0);
+  std::vector<float> scratch(data.cols);
+  for(int i=0; i<data.rows; i++) {
+    const float *row=data.row(i, scratch.data());
+    for(int b=0; b<block_count; b++) {
+      const double term=BlockTerm(&detector[b*block_values], row+b*block_values, block_values);
+      terms[(size_t)i*block_count+b]=(float)term;
+      contribution[b]+=std::fabs(term);
+    }
+  }
+  std::vector<int> order(block_count);
+  for(int b=0; b<block_count; b++) order[b]=b;
+  HigherContribution higher;
+  higher.contribution=&contribution;
+  std::sort(order.begin(), order.end(), higher);
+
+  std::vector<int> cuts;
+  std::vector<double> fractions(stage_fractions);
+  std::sort(fractions.begin(), fractions.end());
+  for(size_t i=0; i<fractions.size(); i++) {
+    if(fractions[i]<=0.0 || fractions[i]>=1.0) continue;
+    const int cut=std::max(1, (int)std::round(fractions[i]*block_count));
+    if(cut<block_count && (cuts.empty() || cut>cuts.back())) cuts.push_back(cut);
+  }
+  cuts.push_back(block_count);
+  for(size_t s=0, begin=0; s<cuts.size(); begin=cuts[s], s++) {
+    CascadeStage stage;
+    stage.blocks.assign(order.begin()+begin, order.begin()+cuts[s]);
+    stage.threshold=0.f;
+    cascade.stages.push_back(stage);
+  }
+
+  // Positives the full detector accepts are the ones the cascade must keep.
+  std::vector<int> positives, negatives;
+  for(int i=0; i<data.rows; i++) {
+    if(data.labels[i]<=0) negatives.push_back(i);
+    else if(DecisionValue(detector, data.row(i, scratch.data()), data.cols)>=0) positives.push_back(i);
+  }
+  const int early_stages=(int)cascade.stages.size()-1;
+  const int budget=(early_stages>0 ? (int)std::floor((1.0-recall)*positives.size()/early_stages) : 0);
+
+  std::vector<double> positive_scores(positives.size(), detector.back());
+  std::vector<double> negative_scores(negatives.size(), detector.back());
+  std::vector<char> positive_alive(positives.size(), 1), negative_alive(negatives.size(), 1);
+  if(report) report->clear();
+  for(size_t s=0; s<cascade.stages.size(); s++) {
+    CascadeStage &stage=cascade.stages[s];
+    for(size_t i=0; i<positives.size(); i++) {
+      for(size_t k=0; k<stage.blocks.size(); k++) positive_scores[i]+=terms[(size_t)positives[i]*block_count+stage.blocks[k]];
+    }
+    for(size_t i=0; i<negatives.size(); i++) {
+      for(size_t k=0; k<stage.blocks.size(); k++) negative_scores[i]+=terms[(size_t)negatives[i]*block_count+stage.blocks[k]];
+    }
+
+    if(s+1<cascade.stages.size()) {
+      // Rejecting below the budget-th smallest surviving score loses at
+      // most `budget` positives here.
+      std::vector<double> alive;
+      for(size_t i=0; i<positives.size(); i++) if(positive_alive[i]) alive.push_back(positive_scores[i]);
+      if(alive.empty()) stage.threshold=-std::numeric_limits<float>::max();
+      else {
+        const int index=std::min(budget, (int)alive.size()-1);
+        std::nth_element(alive.begin(), alive.begin()+index, alive.end());
+        stage.threshold=(float)alive[index];
+        if(stage.threshold>alive[index]) stage.threshold=std::nextafter(stage.threshold, -std::numeric_limits<float>::max());
+      }
+    }
+
+    int positives_lost=0, negatives_rejected=0;
+    for(size_t i=0; i<positives.size(); i++) {
+      if(positive_alive[i] && positive_scores[i]<stage.threshold) {
+        positive_alive[i]=0;
+        positives_lost++;
+      }
+    }
+    for(size_t i=0; i<negatives.size(); i++) {
+      if(negative_alive[i] && negative_scores[i]<stage.threshold) {
+        negative_alive[i]=0;
+        negatives_rejected++;
+      }
+    }
+    if(report) {
+      CascadeStageReport line;
+      line.blocks=(int)stage.blocks.size();
+      line.positives_lost=(positives.empty() ? 0.0 : (double)positives_lost/positives.size());
+      line.negatives_rejected=(negatives.empty() ? 0.0 : (double)negatives_rejected/negatives.size());
+      report->push_back(line);
+    }
+  }
+  return true;
+}
+
+bool SaveCascade(const std::string &cascade_file, const LinearCascade &cascade) {
+  std::ofstream output(cascade_file.c_str(), std::ios::out|std::ios::trunc);
+  if(!output) return false;
+  output.precision(9);
+  output << kCascadeHeader << "\n";
+  output << "window " << cascade.window_size.width << " " << cascade.window_size.height << "\n";
+  output << "block " << cascade.block_size.width << " " << cascade.block_size.height << "\n";
+  output << "stride " << cascade.block_stride.width << " " << cascade.block_stride.height << "\n";
+  output << "cell " << cascade.cell_size.width << " " << cascade.cell_size.height << "\n";
+  output << "bins " << cascade.nbins << "\n";
+  for(size_t s=0; s<cascade.stages.size(); s++) {
+    const CascadeStage &stage=cascade.stages[s];
+    output << "stage " << stage.threshold << " " << stage.blocks.size();
+    for(size_t i=0; i<stage.blocks.size(); i++) output << " " << stage.blocks[i];
+    output << "\n";
+  }
+  output << "detector " << cascade.detector.size() << "\n";
+  for(size_t i=0; i<cascade.detector.size(); i++) output << cascade.detector[i] << "\n";
+  return (bool)output;
+}
+
+bool LoadCascade(const std::string &cascade_file, LinearCascade &cascade) {
+  std::ifstream input(cascade_file.c_str());
+  std::string line;
+  if(!std::getline(input, line) || line!=kCascadeHeader) return false;
+
+  cascade.stages.clear();
+  cascade.detector.clear();
+  while(std::getline(input, line)) {
+    std::istringstream fields(line);
+    std::string key;
+    fields >> key;
+    if(key=="window") fields >> cascade.window_size.width >> cascade.window_size.height;
+    else if(key=="block") fields >> cascade.block_size.width >> cascade.block_size.height;
+    else if(key=="stride") fields >> cascade.block_stride.width >> cascade.block_stride.height;
+    else if(key=="cell") fields >> cascade.cell_size.width >> cascade.cell_size.height;
+    else if(key=="bins") fields >> cascade.nbins;
+    else if(key=="stage") {
+      CascadeStage stage;
+      size_t count=0;
+      fields >> stage.threshold >> count;
+      stage.blocks.resize(count);
+      for(size_t i=0; i<count; i++) fields >> stage.blocks[i];
+      cascade.stages.push_back(stage);
+    } else if(key=="detector") {
+      size_t count=0;
+      fields >> count;
+      cascade.detector.resize(count);
+      for(size_t i=0; i<count; i++) input >> cascade.detector[i];
+    } else continue;
+    if(!fields) return false;
+  }
+
+  const int block_count=cascade.blocks_x()*cascade.blocks_y();
+  if((int)cascade.detector.size()!=block_count*cascade.block_values()+1 || cascade.stages.empty()) return false;
+  for(size_t s=0; s<cascade.stages.size(); s++) {
+    for(size_t i=0; i<cascade.stages[s].blocks.size(); i++) {
+      if(cascade.stages[s].blocks[i]<0 || cascade.stages[s].blocks[i]>=block_count) return false;
+    }
+  }
+  return true;
+}
+
+void DetectWithCascade(const LinearCascade &cascade, const cv::Mat &image, double scale_step,
+                       std::vector<ScoredDetection> &detections, CascadeCounters *counters) {
+  detections.clear();
+  // The frame goes to HOG as given, like in training and detectMultiScale:
+  // on BGR input HOG takes the strongest gradient across the channels,
+  // which a gray conversion would change.
+  std::vector<double> scales;
+  for(double scale=1.0; image.cols/scale>=cascade.window_size.width && image.rows/scale>=cascade.window_size.height; scale*=scale_step) {
+    scales.push_back(scale);
+    if(scale_step<=1.0) break;
+  }
+
+  std::vector< std::vector<ScoredDetection> > found(scales.size());
+  CascadeCounters zero;
+  zero.windows=zero.blocks=0;
+  std::vector<CascadeCounters> level_counters(scales.size(), zero);
+  cv::parallel_for_(cv::Range(0, (int)scales.size()), CascadeLevel(cascade, image, scales, found, level_counters));
+
+  for(size_t level=0; level<found.size(); level++) {
+    detections.insert(detections.end(), found[level].begin(), found[level].end());
+  }
+  if(counters) {
+    for(size_t level=0; level<level_counters.size(); level++) {
+      counters->windows+=level_counters[level].windows;
+      counters->blocks+=level_counters[level].blocks;
+    }
+  }
+}
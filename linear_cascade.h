@@ -0,0 +1,84 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  linear_cascade.h
+ *
+ *    Description:  Early-rejection cascade over the blocks of a linear HOG detector
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 19시 20분 44초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_LINEAR_CASCADE_H_
+#define VIDEOTRAINER_LINEAR_CASCADE_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "feature_file.h"
+#include "nms.h"
+
+// A window's score w.x+b is a sum of per-block dot products. A stage adds
+// the terms of a few more blocks to the running score and rejects the
+// window once it falls below the stage threshold; the last stage holds the
+// remaining blocks and the ordinary decision threshold of 0.
+struct CascadeStage {
+  std::vector<int> blocks;  // block indices in descriptor order (bx*blocks_y+by)
+  float threshold;
+};
+
+struct LinearCascade {
+  cv::Size window_size;
+  cv::Size block_size;
+  cv::Size block_stride;
+  cv::Size cell_size;
+  int nbins;
+  std::vector<float> detector;  // weights followed by the bias
+  std::vector<CascadeStage> stages;
+
+  int blocks_x() const { return (window_size.width-block_size.width)/block_stride.width+1; }
+  int blocks_y() const { return (window_size.height-block_size.height)/block_stride.height+1; }
+  int block_values() const { return (block_size.width/cell_size.width)*(block_size.height/cell_size.height)*nbins; }
+};
+
+struct CascadeStageReport {
+  int blocks;
+  double negatives_rejected;  // share of negative rows stopped by this stage
+  double positives_lost;      // share of detected positive rows stopped by this stage
+};
+
+// Orders the blocks by their mean |w_b.x_b| over the training rows and cuts
+// them into stages at the cumulative `stage_fractions` (e.g. 0.1,0.25,0.5).
+// Each early stage then gets the highest threshold that loses at most
+// (1-recall)/(early stages) of the positive rows the full detector accepts.
+bool BuildCascade(const FeatureMatrix &data, const std::vector<float> &detector,
+                  const cv::HOGDescriptor &hog, const std::vector<double> &stage_fractions,
+                  double recall, LinearCascade &cascade,
+                  std::vector<CascadeStageReport> *report=0);
+
+bool SaveCascade(const std::string &cascade_file, const LinearCascade &cascade);
+bool LoadCascade(const std::string &cascade_file, LinearCascade &cascade);
+
+// Blocks whose terms were summed, over all scored windows; with the window
+// count this gives the saving over full scoring.
+struct CascadeCounters {
+  long long windows;
+  long long blocks;
+};
+
+// Sliding-window detection over an image pyramid like detectMultiScale,
+// but block histograms are computed once per level (HOG with a one-block
+// window) and each window is scored stage by stage, stopping at the first
+// rejection. Survivors come back with their full score, unsuppressed.
+void DetectWithCascade(const LinearCascade &cascade, const cv::Mat &image, double scale_step,
+                       std::vector<ScoredDetection> &detections, CascadeCounters *counters=0);
+
+#endif
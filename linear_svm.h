@@ -0,0 +1,69 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  linear_svm.h
+ *
+ *    Description:  Warm-startable linear SVM solver
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 13시 58분 40초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_LINEAR_SVM_H_
+#define VIDEOTRAINER_LINEAR_SVM_H_
+
+#include <string>
+#include <vector>
+
+#include "feature_file.h"
+
+enum SvmLoss {
+  kHingeLoss,              // C-SVC, L1 loss
+  kSquaredHingeLoss,       // C-SVC, L2 loss
+  kEpsilonInsensitiveLoss  // epsilon-SVR, L1 loss (what svmtrainhog used)
+};
+
+struct LinearSvmParams {
+  SvmLoss loss;
+  double C;
+  double p;          // epsilon of the SVR loss
+  double tolerance;  // stop once the projected gradient range is below this
+  int max_iterations;
+  unsigned int seed;
+
+  LinearSvmParams()
+    : loss(kHingeLoss), C(0.01), p(0.1), tolerance(1e-3), max_iterations(1000), seed(1) {}
+};
+
+// Dual coordinate descent (Hsieh et al., ICML 2008) on
+//
+//   0.5*|w - w0|^2 + C * sum_i loss(y_i, w.x_i + b)
+//
+// `detector` holds w0 with the bias last, in the layout
+// cv::HOGDescriptor::setSVMDetector() takes, and receives the result. An
+// empty detector trains from scratch. All dual variables start at zero, so
+// the solver starts exactly at the previous model and only the rows passed
+// in are visited.
+//
+// `rows` restricts training to a subset (all rows when null). On return
+// `alpha`, if given, holds the dual value of every row; non-zero rows are the
+// support vectors. Returns the number of passes over the data.
+int TrainLinearSvm(const FeatureMatrix &data,
+                   const LinearSvmParams &params,
+                   std::vector<float> &detector,
+                   std::vector<double> *alpha=0,
+                   const std::vector<int> *rows=0);
+
+// w.x + b for one row.
+double DecisionValue(const std::vector<float> &detector, const float *row, int cols);
+
+bool ParseSvmLoss(const std::string &name, SvmLoss &loss);
+const char *SvmLossName(SvmLoss loss);
+
+#endif
@@ -0,0 +1,192 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  nms.cpp
+ *
+ *    Description:  Spatial-grid non-maximum suppression of scored detections
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 16시 52분 26초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "nms.h"
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace {
+
+// Caps grid memory when a few boxes are spread over a huge extent.
+const int kMaxGridCells = 1<<16;
+
+class DetectionGrid {
+ public:
+  explicit DetectionGrid(const std::vector<ScoredDetection> &detections) {
+    int min_x=0, min_y=0, max_x=1, max_y=1;
+    std::vector<int> sizes;
+    for(size_t i=0; i<detections.size(); i++) {
+      const cv::Rect &box=detections[i].box;
+      if(i==0 || box.x<min_x) min_x=box.x;
+      if(i==0 || box.y<min_y) min_y=box.y;
+      if(i==0 || box.x+box.width>max_x) max_x=box.x+box.width;
+      if(i==0 || box.y+box.height>max_y) max_y=box.y+box.height;
+      sizes.push_back(std::max(box.width, box.height));
+    }
+    cell_=1;
+    if(!sizes.empty()) {
+      std::nth_element(sizes.begin(), sizes.begin()+sizes.size()/2, sizes.end());
+      cell_=std::max(sizes[sizes.size()/2], 1);
+    }
+    origin_x_=min_x;
+    origin_y_=min_y;
+    for(;;) {
+      columns_=(max_x-min_x)/cell_+1;
+      rows_=(max_y-min_y)/cell_+1;
+      if((long long)columns_*rows_<=kMaxGridCells) break;
+      cell_*=2;
+    }
+    cells_.resize(columns_*rows_);
+  }
+
+  void Insert(int index, const cv::Rect &box) {
+    int x0, y0, x1, y1;
+    Span(box, x0, y0, x1, y1);
+    for(int y=y0; y<=y1; y++) for(int x=x0; x<=x1; x++) cells_[y*columns_+x].push_back(index);
+  }
+
+  // Indices stored in any cell the box touches; may repeat.
+  template <typename Visit>
+  void ForEachNear(const cv::Rect &box, Visit visit) const {
+    int x0, y0, x1, y1;
+    Span(box, x0, y0, x1, y1);
+    for(int y=y0; y<=y1; y++) {
+      for(int x=x0; x<=x1; x++) {
+        const std::vector<int> &cell=cells_[y*columns_+x];
+        for(size_t i=0; i<cell.size(); i++) visit(cell[i]);
+      }
+    }
+  }
+
+ private:
+  void Span(const cv::Rect &box, int &x0, int &y0, int &x1, int &y1) const {
+    x0=std::max((box.x-origin_x_)/cell_, 0);
+    y0=std::max((box.y-origin_y_)/cell_, 0);
+    x1=std::min((box.x+box.width-1-origin_x_)/cell_, columns_-1);
+    y1=std::min((box.y+box.height-1-origin_y_)/cell_, rows_-1);
+  }
+
+  int cell_;
+  int origin_x_, origin_y_;
+  int columns_, rows_;
+  std::vector< std::vector<int> > cells_;
+};
+
+double IntersectionOverUnion(const cv::Rect &a, const cv::Rect &b) {
+  const int intersection=(a & b).area();
+  if(intersection==0) return 0.0;
+  return (double)intersection/(a.area()+b.area()-intersection);
+}
+
+struct HigherScore {
+  const std::vector<ScoredDetection> *detections;
+  bool operator()(int a, int b) const {
+    if((*detections)[a].score!=(*detections)[b].score) return (*detections)[a].score>(*detections)[b].score;
+    return a<b;
+  }
+};
+
+void GreedyNms(std::vector<ScoredDetection> &detections, const NmsParams &params) {
+  std::vector<int> order(detections.size());
+  for(size_t i=0; i<order.size(); i++) order[i]=(int)i;
+  HigherScore higher;
+  higher.detections=&detections;
+  std::sort(order.begin(), order.end(), higher);
+
+  // Only kept boxes go into the grid, so each test is against survivors.
+  DetectionGrid grid(detections);
+  std::vector<ScoredDetection> kept;
+  for(size_t k=0; k<order.size(); k++) {
+    const ScoredDetection &candidate=detections[order[k]];
+    bool suppressed=false;
+    grid.ForEachNear(candidate.box, [&](int index) {
+      if(!suppressed && IntersectionOverUnion(candidate.box, kept[index].box)>params.iou_threshold) suppressed=true;
+    });
+    if(suppressed) continue;
+    grid.Insert((int)kept.size(), candidate.box);
+    kept.push_back(candidate);
+  }
+  detections.swap(kept);
+}
+
+void SoftNms(std::vector<ScoredDetection> &detections, const NmsParams &params) {
+  DetectionGrid grid(detections);
+  for(size_t i=0; i<detections.size(); i++) grid.Insert((int)i, detections[i].box);
+
+  // Max-heap with lazy deletion: a decayed box is pushed again with its new
+  // score and stale entries are skipped when popped.
+  typedef std::pair<double, int> Entry;
+  std::priority_queue<Entry> heap;
+  std::vector<char> done(detections.size(), 0);
+  for(size_t i=0; i<detections.size(); i++) {
+    if(detections[i].score<params.score_threshold) done[i]=1;
+    else heap.push(Entry(detections[i].score, (int)i));
+  }
+
+  std::vector<int> visited(detections.size(), -1);
+  std::vector<ScoredDetection> kept;
+  while(!heap.empty()) {
+    const Entry top=heap.top();
+    heap.pop();
+    const int best=top.second;
+    if(done[best] || top.first!=detections[best].score) continue;
+    done[best]=1;
+    kept.push_back(detections[best]);
+
+    // A box spanning several cells is listed in each; decay it once.
+    const cv::Rect best_box=detections[best].box;
+    grid.ForEachNear(best_box, [&](int index) {
+      if(done[index] || visited[index]==best) return;
+      visited[index]=best;
+      const double iou=IntersectionOverUnion(best_box, detections[index].box);
+      if(iou<=0.0) return;
+      const double decayed=detections[index].score*std::exp(-iou*iou/params.sigma);
+      if(decayed==detections[index].score) return;
+      detections[index].score=decayed;
+      if(decayed<params.score_threshold) done[index]=1;
+      else heap.push(Entry(decayed, index));
+    });
+  }
+  detections.swap(kept);
+}
+
+}
+
+void SuppressNonMaxima(std::vector<ScoredDetection> &detections, const NmsParams &params) {
+  if(detections.size()<2) return;
+  if(params.mode==kSoftNms) SoftNms(detections, params);
+  else GreedyNms(detections, params);
+}
+
+void ToScoredDetections(const std::vector<cv::Rect> &locations,
+                        const std::vector<double> &weights,
+                        std::vector<ScoredDetection> &detections) {
+  detections.resize(locations.size());
+  for(size_t i=0; i<locations.size(); i++) {
+    detections[i].box=locations[i];
+    detections[i].score=(i<weights.size() ? weights[i] : 0.0);
+  }
+}
+
+bool ParseNmsMode(const std::string &name, NmsMode &mode) {
+  if(name=="greedy") mode=kGreedyNms;
+  else if(name=="soft") mode=kSoftNms;
+  else return false;
+  return true;
+}
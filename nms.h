@@ -0,0 +1,58 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  nms.h
+ *
+ *    Description:  Spatial-grid non-maximum suppression of scored detections
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 16시 52분 26초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_NMS_H_
+#define VIDEOTRAINER_NMS_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+struct ScoredDetection {
+  cv::Rect box;
+  double score;
+};
+
+enum NmsMode {
+  kGreedyNms,  // drop every box overlapping a better one by more than iou_threshold
+  kSoftNms     // decay overlapping scores by exp(-iou^2/sigma) (Bodla et al. 2017)
+};
+
+struct NmsParams {
+  NmsMode mode;
+  double iou_threshold;
+  double sigma;
+  double score_threshold;  // soft NMS drops boxes decayed below this
+
+  NmsParams() : mode(kGreedyNms), iou_threshold(0.3), sigma(0.5), score_threshold(0.0) {}
+};
+
+// Boxes are bucketed into a uniform grid sized to the median box, so each
+// candidate is only compared with the few boxes sharing its cells instead
+// of with every other candidate as cv::groupRectangles does. Survivors are
+// left in `detections` by descending score.
+void SuppressNonMaxima(std::vector<ScoredDetection> &detections, const NmsParams &params);
+
+// Pairs detectMultiScale's rectangles with their weights.
+void ToScoredDetections(const std::vector<cv::Rect> &locations,
+                        const std::vector<double> &weights,
+                        std::vector<ScoredDetection> &detections);
+
+bool ParseNmsMode(const std::string &name, NmsMode &mode);
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  pyramid_detector.cpp
+ *
+ *    Description:  Multi-scale HOG detection under a per-frame deadline
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 21시 07분 52초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "pyramid_detector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+// detectMultiScale's own cap.
+const int kMaxLevels = 64;
+
+// Weight of the newest level in the running per-pixel cost.
+const double kCostSmoothing = 0.2;
+
+struct Level {
+  double scale;
+  cv::Size size;
+  bool scored;
+  std::vector<ScoredDetection> found;
+};
+
+class LevelLanes : public cv::ParallelLoopBody {
+ public:
+  LevelLanes(const cv::HOGDescriptor &hog, const cv::Mat &image, Clock::time_point deadline,
+             std::vector<Level> &levels, std::atomic<int> &next, std::mutex &mutex, double &seconds_per_pixel)
+    : hog_(hog), image_(image), deadline_(deadline), levels_(levels), next_(next),
+      mutex_(mutex), seconds_per_pixel_(seconds_per_pixel) {}
+
+  void operator()(const cv::Range &range) const {
+    std::vector<cv::Point> points;
+    std::vector<double> weights;
+    cv::Mat resized;
+    for(int lane=range.start; lane<range.end; lane++) {
+      for(int index; (index=next_++)<(int)levels_.size(); ) {
+        Level &level=levels_[index];
+        const double pixels=(double)level.size.area();
+        double cost;
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          cost=pixels*seconds_per_pixel_;
+        }
+        const Clock::time_point start=Clock::now();
+        if(start+std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(cost))>deadline_) continue;
+
+        if(level.scale==1.0) resized=image_;
+        else cv::resize(image_, resized, level.size);
+        points.clear();
+        weights.clear();
+        hog_.detect(resized, points, weights, 0, cv::Size(), cv::Size());
+        for(size_t i=0; i<points.size(); i++) {
+          ScoredDetection detection;
+          detection.box=cv::Rect((int)std::round(points[i].x*level.scale), (int)std::round(points[i].y*level.scale),
+                                 (int)std::round(hog_.winSize.width*level.scale), (int)std::round(hog_.winSize.height*level.scale));
+          detection.score=(i<weights.size() ? weights[i] : 0.0);
+          level.found.push_back(detection);
+        }
+        level.scored=true;
+
+        const double seconds=std::chrono::duration<double>(Clock::now()-start).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        const double observed=seconds/std::max(pixels, 1.0);
+        seconds_per_pixel_=(seconds_per_pixel_>0 ? (1-kCostSmoothing)*seconds_per_pixel_+kCostSmoothing*observed : observed);
+      }
+    }
+  }
+
+ private:
+  const cv::HOGDescriptor &hog_;
+  const cv::Mat &image_;
+  Clock::time_point deadline_;
+  std::vector<Level> &levels_;
+  std::atomic<int> &next_;
+  std::mutex &mutex_;
+  double &seconds_per_pixel_;
+};
+
+bool Coarser(const Level &a, const Level &b) {
+  return a.scale>b.scale;
+}
+
+}
+
+DeadlinePyramid::DeadlinePyramid(double scale_step)
+    : scale_step_(scale_step), seconds_per_pixel_(0.0) {}
+
+void DeadlinePyramid::Detect(const cv::HOGDescriptor &hog, const cv::Mat &image, Clock::time_point deadline,
+                             std::vector<ScoredDetection> &detections, PyramidReport *report) {
+  detections.clear();
+  std::vector<Level> levels;
+  double scale=1.0;
+  for(int i=0; i<kMaxLevels; i++, scale*=scale_step_) {
+    const cv::Size size((int)std::round(image.cols/scale), (int)std::round(image.rows/scale));
+    if(size.width<hog.winSize.width || size.height<hog.winSize.height) break;
+    Level level;
+    level.scale=scale;
+    level.size=size;
+    level.scored=false;
+    levels.push_back(level);
+    if(scale_step_<=1.0) break;
+  }
+
+  // Levels skipped last frame go first, then the rest coarse to fine.
+  std::stable_sort(levels.begin(), levels.end(), Coarser);
+  std::stable_partition(levels.begin(), levels.end(), [this](const Level &level) {
+    return std::find(deferred_.begin(), deferred_.end(), level.scale)!=deferred_.end();
+  });
+
+  std::atomic<int> next(0);
+  const int lanes=std::max(1, std::min((int)levels.size(), cv::getNumThreads()));
+  cv::parallel_for_(cv::Range(0, lanes), LevelLanes(hog, image, deadline, levels, next, mutex_, seconds_per_pixel_));
+
+  deferred_.clear();
+  int scored=0;
+  for(size_t i=0; i<levels.size(); i++) {
+    if(!levels[i].scored) {
+      deferred_.push_back(levels[i].scale);
+      continue;
+    }
+    scored++;
+    detections.insert(detections.end(), levels[i].found.begin(), levels[i].found.end());
+  }
+  if(report) {
+    report->levels=(int)levels.size();
+    report->scored=scored;
+    report->partial=(scored<(int)levels.size());
+  }
+}
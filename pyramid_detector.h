@@ -0,0 +1,64 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  pyramid_detector.h
+ *
+ *    Description:  Multi-scale HOG detection under a per-frame deadline
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 21시 07분 52초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_PYRAMID_DETECTOR_H_
+#define VIDEOTRAINER_PYRAMID_DETECTOR_H_
+
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "nms.h"
+
+struct PyramidReport {
+  int levels;   // pyramid levels the frame has
+  int scored;   // levels scored before the deadline
+  bool partial; // some levels were left for the next frame
+};
+
+// detectMultiScale split into one task per pyramid level. Levels run on
+// OpenCV's thread pool, coarsest (cheapest, largest objects) first. A level
+// only starts if its estimated cost -- pixels times a running per-pixel
+// time -- still fits before the deadline; the rest are skipped and go to
+// the front of the queue on the next frame, so under sustained overload
+// every scale is still visited every few frames.
+//
+// Keeps per-stream state: use one instance per video stream, from one
+// thread at a time.
+class DeadlinePyramid {
+ public:
+  explicit DeadlinePyramid(double scale_step=1.05);
+
+  // Same windows and boxes as hog.detectMultiScale with grouping off,
+  // with their scores. A deadline of time_point::max() scores every level.
+  void Detect(const cv::HOGDescriptor &hog, const cv::Mat &image,
+              std::chrono::steady_clock::time_point deadline,
+              std::vector<ScoredDetection> &detections, PyramidReport *report=0);
+
+ private:
+  DeadlinePyramid(const DeadlinePyramid &);
+  DeadlinePyramid &operator=(const DeadlinePyramid &);
+
+  double scale_step_;
+  std::vector<double> deferred_;  // scales skipped on the previous frame
+  std::mutex mutex_;
+  double seconds_per_pixel_;
+};
+
+#endif
@@ -0,0 +1,269 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  stream_scheduler.cpp
+ *
+ *    Description:  Shares one pool of detection workers between many video streams
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 04분 17초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "stream_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+// Files whose container reports no usable rate are paced as if shot at this.
+const double kFallbackFps = 30.0;
+
+// One slot being processed, one pending and one being decoded.
+const int kFramesPerStream = 3;
+
+bool IsDevice(const std::string &source) {
+  return !source.empty() && source.find_first_not_of("0123456789")==std::string::npos;
+}
+
+}
+
+struct StreamScheduler::Stream {
+  StreamConfig config;
+  cv::VideoCapture video;
+  FramePool pool;
+  int pending_slot;
+  int pending_index;
+  Clock::time_point pending_time;
+  bool in_flight;
+  StreamStats stats;
+
+  Stream() : pool(kFramesPerStream), pending_slot(-1), pending_index(0), in_flight(false) {
+    stats.decoded=stats.published=stats.processed=stats.dropped=0;
+    stats.busy_seconds=stats.latency_seconds=0.0;
+  }
+};
+
+bool ParseStreamConfig(const std::string &spec, double default_fps, StreamConfig &config) {
+  std::string rest=spec;
+  config.fps=default_fps;
+  config.priority=0;
+  try {
+    const size_t hash=rest.rfind('#');
+    if(hash!=std::string::npos) {
+      config.priority=std::stoi(rest.substr(hash+1));
+      rest.erase(hash);
+    }
+    const size_t at=rest.rfind('@');
+    if(at!=std::string::npos) {
+      config.fps=std::stod(rest.substr(at+1));
+      rest.erase(at);
+    }
+  }
+  catch(std::exception &) {
+    return false;
+  }
+  config.source=rest;
+  return !rest.empty();
+}
+
+bool ParseStreamPolicy(const std::string &name, StreamPolicy &policy) {
+  if(name=="fair") policy=kFairSharePolicy;
+  else if(name=="priority") policy=kPriorityPolicy;
+  else return false;
+  return true;
+}
+
+StreamScheduler::StreamScheduler(const std::vector<StreamConfig> &streams, StreamPolicy policy,
+                                 bool realtime, int thread_count, FrameFormat format)
+    : policy_(policy), realtime_(realtime), thread_count_(thread_count), format_(format),
+      stopping_(false), active_captures_(0), busy_workers_(0) {
+  if(thread_count_<=0) thread_count_=(int)std::thread::hardware_concurrency();
+  if(thread_count_<=0) thread_count_=1;
+  for(size_t i=0; i<streams.size(); i++) {
+    streams_.push_back(std::unique_ptr<Stream>(new Stream));
+    streams_.back()->config=streams[i];
+  }
+}
+
+StreamScheduler::~StreamScheduler() {
+  Stop();
+}
+
+bool StreamScheduler::Start(const StreamProcessor &process) {
+  for(size_t i=0; i<streams_.size(); i++) {
+    Stream &stream=*streams_[i];
+    if(IsDevice(stream.config.source)) {
+      stream.video.open(std::stoi(stream.config.source));
+      if(format_==kLumaFrames) stream.video.set(cv::CAP_PROP_CONVERT_RGB, 0);
+    } else OpenVideo(stream.video, stream.config.source, format_);
+    if(!stream.video.isOpened()) {
+      std::cerr << "Error opening stream " << stream.config.source << std::endl;
+      return false;
+    }
+  }
+
+  process_=process;
+  stopping_=false;
+  active_captures_=(int)streams_.size();
+  for(size_t i=0; i<streams_.size(); i++) threads_.push_back(std::thread(&StreamScheduler::Capture, this, (int)i));
+  for(int worker=0; worker<thread_count_; worker++) threads_.push_back(std::thread(&StreamScheduler::Work, this, worker));
+  return true;
+}
+
+void StreamScheduler::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_=true;
+  }
+  work_.notify_all();
+  space_.notify_all();
+  for(size_t i=0; i<threads_.size(); i++) threads_[i].join();
+  threads_.clear();
+  done_.notify_all();
+}
+
+bool StreamScheduler::Wait(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return done_.wait_for(lock, timeout, [this] { return Done(); });
+}
+
+StreamStats StreamScheduler::stats(int stream) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return streams_[stream]->stats;
+}
+
+bool StreamScheduler::Done() const {
+  if(stopping_) return true;
+  if(active_captures_>0 || busy_workers_>0) return false;
+  for(size_t i=0; i<streams_.size(); i++) if(streams_[i]->pending_slot>=0) return false;
+  return true;
+}
+
+void StreamScheduler::Capture(int index) {
+  Stream &stream=*streams_[index];
+  const bool live=IsDevice(stream.config.source);
+  double source_fps=stream.video.get(cv::CAP_PROP_FPS);
+  if(!(source_fps>0 && source_fps<1000)) source_fps=kFallbackFps;
+  const double publish_period=(stream.config.fps>0 ? 1.0/stream.config.fps : 0.0);
+
+  // The fps target is applied on the media clock: wall time for devices,
+  // frame timestamps for files, so file runs decimate the same frames no
+  // matter how fast they are read.
+  const Clock::time_point start=Clock::now();
+  double next_publish=0.0;
+  cv::Mat raw;
+  for(int frame_index=0; ; frame_index++) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if(stopping_) break;
+    }
+    if(realtime_ && !live) {
+      std::this_thread::sleep_until(start+std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(frame_index/source_fps)));
+    }
+    const double media_time=(live ? std::chrono::duration<double>(Clock::now()-start).count() : frame_index/source_fps);
+    if(publish_period>0 && media_time<next_publish) {
+      // Frames between fps ticks are grabbed but never converted.
+      if(!stream.video.grab()) break;
+      std::lock_guard<std::mutex> lock(mutex_);
+      stream.stats.decoded++;
+      continue;
+    }
+    next_publish+=publish_period;
+    if(next_publish<=media_time) next_publish=media_time+publish_period;
+
+    const int slot=stream.pool.Acquire();
+    if(!ReadFrame(stream.video, format_, raw, stream.pool.frame(slot))) {
+      stream.pool.Release(slot);
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    stream.stats.decoded++;
+    if(!realtime_) space_.wait(lock, [&] { return stopping_ || stream.pending_slot<0; });
+    if(stream.pending_slot>=0) {
+      // Nobody got to the previous frame in time; the newer one replaces it.
+      stream.pool.Release(stream.pending_slot);
+      stream.stats.dropped++;
+    }
+    stream.pending_slot=slot;
+    stream.pending_index=frame_index;
+    stream.pending_time=Clock::now();
+    stream.stats.published++;
+    lock.unlock();
+    work_.notify_one();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    active_captures_--;
+  }
+  work_.notify_all();
+  done_.notify_all();
+}
+
+int StreamScheduler::PickStream() {
+  int best=-1;
+  for(int i=0; i<(int)streams_.size(); i++) {
+    const Stream &stream=*streams_[i];
+    if(stream.pending_slot<0 || stream.in_flight) continue;
+    if(best<0) {
+      best=i;
+      continue;
+    }
+    const Stream &current=*streams_[best];
+    if(policy_==kPriorityPolicy && stream.config.priority!=current.config.priority) {
+      if(stream.config.priority>current.config.priority) best=i;
+      continue;
+    }
+    if(stream.stats.busy_seconds!=current.stats.busy_seconds) {
+      if(stream.stats.busy_seconds<current.stats.busy_seconds) best=i;
+      continue;
+    }
+    if(stream.pending_time<current.pending_time) best=i;
+  }
+  return best;
+}
+
+void StreamScheduler::Work(int worker) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for(;;) {
+    int index=-1;
+    while(!stopping_ && (index=PickStream())<0 && active_captures_>0) work_.wait(lock);
+    // With every capture finished, a stream still in flight is drained by
+    // the worker that holds it.
+    if(stopping_ || index<0) break;
+
+    Stream &stream=*streams_[index];
+    const int slot=stream.pending_slot;
+    const int frame_index=stream.pending_index;
+    const Clock::time_point published=stream.pending_time;
+    stream.pending_slot=-1;
+    stream.in_flight=true;
+    busy_workers_++;
+    lock.unlock();
+    space_.notify_all();
+
+    const Clock::time_point begin=Clock::now();
+    process_(index, stream.pool.frame(slot), frame_index, worker);
+    const Clock::time_point end=Clock::now();
+    stream.pool.Release(slot);
+
+    lock.lock();
+    stream.in_flight=false;
+    busy_workers_--;
+    stream.stats.processed++;
+    stream.stats.busy_seconds+=std::chrono::duration<double>(end-begin).count();
+    stream.stats.latency_seconds+=std::chrono::duration<double>(end-published).count();
+    if(Done()) done_.notify_all();
+  }
+  done_.notify_all();
+}
@@ -0,0 +1,122 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  stream_scheduler.h
+ *
+ *    Description:  Shares one pool of detection workers between many video streams
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 04분 17초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_STREAM_SCHEDULER_H_
+#define VIDEOTRAINER_STREAM_SCHEDULER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include <boost/function.hpp>
+
+#include "frame_pool.h"
+#include "video_scheduler.h"
+
+struct StreamConfig {
+  std::string source;  // a video file, or a device number
+  double fps;          // frames per second to hand to the workers; <=0 takes every frame
+  int priority;        // higher runs first under kPriorityPolicy
+};
+
+// Parses "source[@fps][#priority]", e.g. "lobby.mp4@10#2" or "0@15".
+bool ParseStreamConfig(const std::string &spec, double default_fps, StreamConfig &config);
+
+enum StreamPolicy {
+  kFairSharePolicy,  // the ready stream that has used the least worker time goes next
+  kPriorityPolicy    // the highest priority ready stream goes next, fair share among equals
+};
+
+bool ParseStreamPolicy(const std::string &name, StreamPolicy &policy);
+
+struct StreamStats {
+  long long decoded;    // frames read or grabbed from the source
+  long long published;  // frames offered to the workers at the fps target
+  long long processed;
+  long long dropped;    // offered frames replaced by a newer one before a worker got to them
+  double busy_seconds;
+  double latency_seconds;  // summed from decode to the end of processing
+};
+
+// `frame` belongs to the scheduler and is only valid during the call; it
+// may be drawn on in place.
+typedef boost::function<void (int stream, cv::Mat &frame, int frame_index, int worker)> StreamProcessor;
+
+// Each stream has a capture thread that decodes into its own frame pool
+// and offers at most one pending frame. Workers take pending frames
+// according to the policy, one frame per stream at a time so per-stream
+// output stays ordered. With realtime on, files are paced at their own
+// frame rate like live feeds and a pending frame that is still waiting
+// when the next one arrives is dropped, so an overloaded process skips
+// frames instead of falling further behind. With realtime off capture
+// waits for the workers, which processes every offered frame of a file.
+class StreamScheduler {
+ public:
+  StreamScheduler(const std::vector<StreamConfig> &streams, StreamPolicy policy,
+                  bool realtime, int thread_count=0, FrameFormat format=kBgrFrames);
+  ~StreamScheduler();
+
+  int stream_count() const { return (int)streams_.size(); }
+  int thread_count() const { return thread_count_; }
+
+  // Opens every source and starts capturing and processing. Returns false
+  // (with nothing started) if a source cannot be opened.
+  bool Start(const StreamProcessor &process);
+
+  // Asks every thread to finish and joins them.
+  void Stop();
+
+  // Blocks until every stream has ended and its last frame was processed,
+  // or until `timeout` passes. Returns true once everything is done.
+  bool Wait(std::chrono::milliseconds timeout);
+
+  StreamStats stats(int stream);
+
+ private:
+  struct Stream;
+
+  StreamScheduler(const StreamScheduler &);
+  StreamScheduler &operator=(const StreamScheduler &);
+
+  void Capture(int stream);
+  void Work(int worker);
+  int PickStream();
+  bool Done() const;
+
+  std::vector< std::unique_ptr<Stream> > streams_;
+  StreamPolicy policy_;
+  bool realtime_;
+  int thread_count_;
+  FrameFormat format_;
+  StreamProcessor process_;
+
+  std::mutex mutex_;
+  std::condition_variable work_;   // a frame became pending, or a stream ended
+  std::condition_variable space_;  // a pending frame was taken
+  std::condition_variable done_;
+  bool stopping_;
+  int active_captures_;
+  int busy_workers_;
+  std::vector<std::thread> threads_;
+};
+
+#endif
@@ -0,0 +1,130 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  svmcascade.cpp
+ *
+ *    Description:  Splits a linear detector into an early-rejection cascade
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 19시 20분 44초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "detector_io.h"
+#include "feature_file.h"
+#include "linear_cascade.h"
+
+bool ParseStageFractions(const std::string &list, std::vector<double> &fractions) {
+  std::istringstream input(list);
+  std::string item;
+  fractions.clear();
+  while(std::getline(input, item, ',')) {
+    try {
+      fractions.push_back(std::stod(item));
+    }
+    catch(std::exception &) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  int width, height;
+  double recall;
+  std::string model_file;
+  std::string stage_list;
+  std::string output_file;
+  std::vector<std::string> feature_files;
+  std::vector<double> stage_fractions;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("source,s", po::value< std::vector<std::string> >(&feature_files)->required(), "Specify the feature files to calibrate on (the training rows)")
+    ("model,m", po::value<std::string>(&model_file)->required(), "Specify the detector or OpenCV SVM model to split")
+    ("width,w", po::value<int>(&width)->default_value(128), "Specify train window width")
+    ("height", po::value<int>(&height)->default_value(72), "Specify train window height")
+    ("stages", po::value<std::string>(&stage_list)->default_value("0.1,0.25,0.5"), "Specify the cumulative share of blocks scored by the end of each early stage")
+    ("recall", po::value<double>(&recall)->default_value(0.99), "Specify the share of detected positives the early stages must keep")
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/detector.cascade"), "Specify an output file");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] features..." << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+    if(!ParseStageFractions(stage_list, stage_fractions)) throw std::invalid_argument("bad stage list "+stage_list);
+    if(recall<=0 || recall>1) throw std::invalid_argument("recall must be in (0, 1]");
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  FeatureMatrix data;
+  for(size_t i=0; i<feature_files.size(); i++) {
+    if(!ReadFeatureFile(feature_files[i], data)) {
+      std::cerr << "Error reading feature file " << feature_files[i] << std::endl;
+      return 1;
+    }
+  }
+  std::vector<float> detector;
+  if(!LoadDetector(model_file, detector)) {
+    std::cerr << "Error loading model " << model_file << std::endl;
+    return 1;
+  }
+
+  cv::HOGDescriptor hog;
+  hog.winSize=cv::Size(width, height);
+  LinearCascade cascade;
+  std::vector<CascadeStageReport> report;
+  if(!BuildCascade(data, detector, hog, stage_fractions, recall, cascade, &report)) return 1;
+  if(!SaveCascade(output_file, cascade)) {
+    std::cerr << "Error writing cascade " << output_file << std::endl;
+    return 1;
+  }
+
+  // A negative window pays for a stage only if every earlier stage let it
+  // through; nearly all windows in a frame are negatives.
+  const int block_count=cascade.blocks_x()*cascade.blocks_y();
+  double surviving=1.0, expected_blocks=0.0, recall_kept=1.0;
+  std::cout << "stage\tblocks\tthreshold\tnegatives_rejected\tpositives_lost" << std::endl;
+  for(size_t s=0; s<report.size(); s++) {
+    expected_blocks+=surviving*report[s].blocks;
+    surviving-=report[s].negatives_rejected;
+    if(s+1<report.size()) recall_kept-=report[s].positives_lost;
+    std::cout << s << "\t" << report[s].blocks << "\t" << cascade.stages[s].threshold
+              << "\t" << report[s].negatives_rejected << "\t" << report[s].positives_lost << std::endl;
+  }
+  std::cout << "Cascade written to " << output_file << ": " << expected_blocks << " of " << block_count
+            << " blocks per negative window (" << (expected_blocks>0 ? block_count/expected_blocks : 0.0)
+            << "x), " << recall_kept << " of detected positives kept" << std::endl;
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  svmclient.cpp
+ *
+ *    Description:  Feeds video frames to svmserver and reports the detections
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <boost/program_options.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "detection_client.h"
+#include "video_scheduler.h"
+
+int main(int argc, char** argv) {
+  int detector, camera;
+  bool display, luma;
+  std::string socket_path;
+  std::string source_file;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("socket,s", po::value<std::string>(&socket_path)->default_value("/tmp/svmserver.sock"), "Specify the svmserver socket")
+    ("detector,d", po::value<int>(&detector)->default_value(0), "Specify which of the server's detectors to run")
+    ("source,o", po::value<std::string>(&source_file), "Specify a video file (default reads the camera)")
+    ("camera,c", po::value<int>(&camera)->default_value(0), "Specify camera to retrieve the feed from")
+    ("luma", po::value<bool>(&luma)->default_value(false), "Specify whether to send the luma plane instead of BGR frames")
+    ("display", po::value<bool>(&display)->default_value(false), "Specify whether to show annotated frames in a window");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] [source]" << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  DetectionClient client;
+  if(!client.Connect(socket_path)) {
+    std::cerr << "Error connecting to " << socket_path << std::endl;
+    return 1;
+  }
+  if(detector<0 || detector>=(int)client.detector_names().size()) {
+    std::cerr << "Error: the server has " << client.detector_names().size() << " detectors" << std::endl;
+    return 1;
+  }
+  std::cout << "Using detector " << client.detector_names()[detector] << std::endl;
+
+  const FrameFormat format=(luma ? kLumaFrames : kBgrFrames);
+  cv::VideoCapture video;
+  if(source_file.empty()) {
+    video.open(camera);
+    if(luma) video.set(cv::CAP_PROP_CONVERT_RGB, 0);
+  } else OpenVideo(video, source_file, format);
+  if(!video.isOpened()) {
+    std::cerr << "Error opening a video source" << std::endl;
+    return 1;
+  }
+
+  // After the first frame `frame` is a header over the shared buffer, so the
+  // decoder writes straight into memory the server reads.
+  cv::Mat raw, frame;
+  std::vector<ScoredDetection> detections;
+  for(int frame_index=0; ReadFrame(video, format, raw, frame); frame_index++) {
+    if(!client.Detect(frame, detector, detections)) {
+      std::cerr << "Error: detection request failed" << std::endl;
+      return 1;
+    }
+    std::cout << frame_index << "\t" << detections.size();
+    for(size_t i=0; i<detections.size(); i++) {
+      const cv::Rect &box=detections[i].box;
+      std::cout << "\t" << box.x << "," << box.y << "," << box.width << "x" << box.height << ":" << detections[i].score;
+    }
+    std::cout << std::endl;
+
+    if(display) {
+      for(size_t i=0; i<detections.size(); i++) cv::rectangle(frame, detections[i].box, cv::Scalar(0, 0, 255), 2);
+      cv::imshow("svmclient", frame);
+      if(27==(char)cv::waitKey(1)) break;
+    }
+
+    cv::Mat shared=client.FrameBuffer(frame.rows, frame.cols, frame.channels());
+    if(shared.data!=frame.data) frame=shared;
+  }
+  return 0;
+}
@@ -18,9 +18,58 @@
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <chrono>
 #include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
 #include <opencv2/opencv.hpp>
 
+#include "compact_detector.h"
+#include "detector_io.h"
+#include "linear_cascade.h"
+#include "nms.h"
+#include "pyramid_detector.h"
+#include "stream_scheduler.h"
+#include "video_scheduler.h"
+
+// Reused by one worker across every frame it processes.
+struct DetectScratch {
+  std::vector<cv::Rect> locations;
+  std::vector<double> weights;
+  std::vector<ScoredDetection> detections;
+  CascadeCounters cascade;
+
+  DetectScratch() { cascade.windows=cascade.blocks=0; }
+};
+
+// Sinks of one stream. Only one worker handles a stream at a time; `shown`
+// is also read by the display loop and guarded by `mutex`.
+struct StreamOutput {
+  std::mutex mutex;
+  cv::Mat shown;
+  bool fresh;
+  cv::VideoWriter record;
+  bool record_failed;
+  DeadlinePyramid pyramid;
+  long long partial_frames;  // frames whose finer levels missed the deadline
+
+  StreamOutput() : fresh(false), record_failed(false), partial_frames(0) {}
+};
+
+// "out.avi" for a single stream, "out.<stream>.avi" for several.
+std::string RecordFile(const std::string &record_file, int stream, int stream_count) {
+  if(stream_count==1) return record_file;
+  const boost::filesystem::path path(record_file);
+  return (path.parent_path()/(path.stem().string()+"."+std::to_string(stream)+path.extension().string())).string();
+}
+
+void draw_detections(cv::Mat & img, const std::vector<ScoredDetection> & detections, const cv::Scalar & color) {
+  for(size_t i=0; i<detections.size(); i++) {
+    rectangle( img, detections[i].box, color, 2 );
+  }
+}
+
 void draw_locations(cv::Mat & img, const std::vector<cv::Rect> & locations, const cv::Scalar & color  ) {
   if(!locations.empty()) {
     std::vector<cv::Rect>::const_iterator loc = locations.begin();
@@ -32,8 +81,22 @@ void draw_locations(cv::Mat & img, const std::vector<cv::Rect> & locations, cons
 }
 
 int main ( int argc, const char * argv[] ) {
-  int width, height;
+  int width, height, cell_size;
   std::string source_file;
+  std::string cascade_file;
+  std::string descriptor_name;
+  std::string projection_file;
+  DescriptorMode descriptor;
+  std::string nms_mode;
+  std::string record_file;
+  std::string policy_name;
+  std::vector<std::string> stream_specs;
+  double default_fps;
+  double deadline_ms;
+  bool display, luma, realtime;
+  int thread_count;
+  StreamPolicy policy;
+  NmsParams nms;
   try {
     namespace po=boost::program_options;
     po::options_description desc("Options");
@@ -41,7 +104,24 @@ int main ( int argc, const char * argv[] ) {
     ("help,h", "Print help messages")
     ("width,w", po::value<int>(&width)->default_value(128), "Specify train window width")
     ("height,h", po::value<int>(&height)->default_value(72), "Specify train window height")
-    ("source,o", po::value<std::string>(&source_file)->required(), "Specify an source file");
+    ("source,o", po::value<std::string>(&source_file), "Specify an source file")
+    ("cascade", po::value<std::string>(&cascade_file), "Specify a cascade from svmcascade to score windows with instead of the source detector")
+    ("descriptor", po::value<std::string>(&descriptor_name)->default_value("hog"), "Specify what the detector was trained on: hog, fhog or pca")
+    ("cell", po::value<int>(&cell_size)->default_value(8), "Specify the fhog cell size in pixels")
+    ("projection", po::value<std::string>(&projection_file), "Specify the block projection from featurepca for the pca descriptor")
+    ("stream,s", po::value< std::vector<std::string> >(&stream_specs)->default_value(std::vector<std::string>(1, "0"), "0"), "Specify video sources as file or device[@fps][#priority]; repeat for several streams")
+    ("fps", po::value<double>(&default_fps)->default_value(0), "Specify the default per-stream fps target (0 takes every frame)")
+    ("policy", po::value<std::string>(&policy_name)->default_value("fair"), "Specify how streams share the workers: fair or priority")
+    ("realtime", po::value<bool>(&realtime)->default_value(true), "Specify whether files play at their own rate and stale frames are skipped")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of detection threads (0 uses every core)")
+    ("deadline", po::value<double>(&deadline_ms)->default_value(0), "Specify a per-frame detection budget in ms; finer levels that do not fit move to the next frame (0 scores every level)")
+    ("nms", po::value<std::string>(&nms_mode)->default_value("greedy"), "Specify detection grouping: greedy, soft or opencv (groupRectangles)")
+    ("nms-iou", po::value<double>(&nms.iou_threshold)->default_value(0.3), "Specify the overlap above which greedy NMS suppresses a box")
+    ("soft-sigma", po::value<double>(&nms.sigma)->default_value(0.5), "Specify the Gaussian decay of soft NMS")
+    ("min-score", po::value<double>(&nms.score_threshold)->default_value(0.3), "Specify the score below which soft NMS drops a box")
+    ("luma", po::value<bool>(&luma)->default_value(false), "Specify whether to detect on the luma plane instead of BGR frames")
+    ("display", po::value<bool>(&display)->default_value(true), "Specify whether to show annotated frames in a window")
+    ("record", po::value<std::string>(&record_file), "Specify a video file to write annotated frames to");
 
     po::positional_options_description p;
     p.add("source",-1);
@@ -50,12 +130,20 @@ int main ( int argc, const char * argv[] ) {
     po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
 
     if (vm.count("help")) {
-      std::cout << "Usage: " << argv[0] << " source" << std::endl;
+      std::cout << "Usage: " << argv[0] << " [options] source" << std::endl;
       std::cout << desc;
       return 0;
     }
 
     po::notify(vm);
+    if(source_file.empty() && cascade_file.empty()) throw std::invalid_argument("a source detector or a cascade is required");
+    if(!cascade_file.empty() && nms_mode=="opencv") throw std::invalid_argument("--cascade needs greedy or soft nms");
+    if(!ParseDescriptorMode(descriptor_name, descriptor)) throw std::invalid_argument("unknown descriptor "+descriptor_name);
+    if(descriptor!=kHogDescriptor && (!cascade_file.empty() || nms_mode=="opencv")) throw std::invalid_argument("the "+descriptor_name+" descriptor needs greedy or soft nms and no cascade");
+    if(deadline_ms>0 && (descriptor!=kHogDescriptor || !cascade_file.empty() || nms_mode=="opencv")) throw std::invalid_argument("--deadline works with the hog descriptor and greedy or soft nms");
+    if(descriptor==kPcaDescriptor && projection_file.empty()) throw std::invalid_argument("the pca descriptor needs --projection");
+    if(nms_mode!="opencv" && !ParseNmsMode(nms_mode, nms.mode)) throw std::invalid_argument("unknown nms mode "+nms_mode);
+    if(!ParseStreamPolicy(policy_name, policy)) throw std::invalid_argument("unknown policy "+policy_name);
   }
   catch(std::exception& e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -66,49 +154,141 @@ int main ( int argc, const char * argv[] ) {
     return 1;
   }
 
-  std::vector<float> single_detector_vector;
-  {
-    std::fstream detector_file(source_file.c_str());
-
-    if(!detector_file) {
+  cv::HOGDescriptor hog;
+  LinearCascade cascade;
+  CompactDetector compact;
+  if(descriptor!=kHogDescriptor) {
+    compact.mode=descriptor;
+    compact.hog.winSize=cv::Size(width, height);
+    compact.cell_size=cell_size;
+    if(descriptor==kPcaDescriptor && !LoadBlockProjection(projection_file, compact.projection)) {
+      std::cerr << "Error opening projection " << projection_file << std::endl;
+      return 1;
+    }
+    if(!LoadDetector(source_file, compact.detector)) {
       std::cerr << "Error opening source file" << std::endl;
       return 1;
     }
+    if((int)compact.detector.size()!=compact.descriptor_size()+1) {
+      std::cerr << "Error: detector has " << compact.detector.size()-1 << " weights but " << descriptor_name
+                << " windows have " << compact.descriptor_size() << " values" << std::endl;
+      return 1;
+    }
+    std::cout << "Scoring " << compact.descriptor_size() << "-value " << descriptor_name << " windows" << std::endl;
+  } else if(!cascade_file.empty()) {
+    if(!LoadCascade(cascade_file, cascade)) {
+      std::cerr << "Error opening cascade file " << cascade_file << std::endl;
+      return 1;
+    }
+  } else {
+    std::vector<float> single_detector_vector;
+    if(!LoadDetector(source_file, single_detector_vector)) {
+      std::cerr << "Error opening source file" << std::endl;
+      return 1;
+    }
+    hog.winSize=cv::Size(width, height);
+    hog.setSVMDetector(single_detector_vector);
+  }
 
-    float feature;
-    while(detector_file >> feature) {
-      single_detector_vector.push_back(feature);
+  std::vector<StreamConfig> streams(stream_specs.size());
+  for(size_t i=0; i<stream_specs.size(); i++) {
+    if(!ParseStreamConfig(stream_specs[i], default_fps, streams[i])) {
+      std::cerr << "Error: bad stream " << stream_specs[i] << std::endl;
+      return 1;
     }
   }
 
-  cv::HOGDescriptor hog;
-  hog.winSize=cv::Size(width, height);
-  hog.setSVMDetector(single_detector_vector);
+  StreamScheduler scheduler(streams, policy, realtime, thread_count, luma ? kLumaFrames : kBgrFrames);
+  std::vector<DetectScratch> scratch(scheduler.thread_count());
+  std::vector< std::unique_ptr<StreamOutput> > outputs;
+  for(size_t i=0; i<streams.size(); i++) outputs.push_back(std::unique_ptr<StreamOutput>(new StreamOutput));
+  const bool annotate=display || !record_file.empty();
 
-  cv::VideoCapture cam(0);
-  if(!cam.isOpened()) {
-    std::cerr << "Error opening a video camera source" << std::endl;
-    return 1;
-  }
+  // Frames are decoded into each stream's pooled buffers and the detector
+  // only reads them; boxes are drawn over a frame in place once detection
+  // is done, and only when something will show or record it.
+  const bool started=scheduler.Start([&](int stream, cv::Mat &img, int, int worker) {
+    DetectScratch &s=scratch[worker];
+    const cv::Mat &view=img;
+    s.locations.clear();
+    if(descriptor!=kHogDescriptor) {
+      DetectCompactMultiScale( compact, view, 1.05, s.detections );
+      SuppressNonMaxima( s.detections, nms );
+    } else if(deadline_ms>0) {
+      // Levels run in parallel on OpenCV's pool, coarse first, until the
+      // budget runs out.
+      const std::chrono::steady_clock::time_point deadline=std::chrono::steady_clock::now()
+          +std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(deadline_ms));
+      PyramidReport report;
+      outputs[stream]->pyramid.Detect( hog, view, deadline, s.detections, &report );
+      if(report.partial) outputs[stream]->partial_frames++;
+      SuppressNonMaxima( s.detections, nms );
+    } else if(!cascade_file.empty()) {
+      DetectWithCascade( cascade, view, 1.05, s.detections, &s.cascade );
+      SuppressNonMaxima( s.detections, nms );
+    } else if(nms_mode=="opencv") {
+      hog.detectMultiScale( view, s.locations );
+    } else {
+      // A final threshold of 0 turns off groupRectangles and keeps every
+      // window with its score for our own suppression.
+      s.weights.clear();
+      hog.detectMultiScale( view, s.locations, s.weights, 0, cv::Size(), cv::Size(), 1.05, 0 );
+      ToScoredDetections( s.locations, s.weights, s.detections );
+      SuppressNonMaxima( s.detections, nms );
+    }
+    if(!annotate) return;
 
-  cv::Mat img, draw;
-  char key;
-  std::vector<cv::Rect> locations;
-  bool end_of_process=false;
-  while(!end_of_process)
-  {
-    cam >> img;
-    if(img.empty()) break;
+    if(nms_mode=="opencv") draw_locations( img, s.locations, cv::Scalar(0, 0, 255));
+    else draw_detections( img, s.detections, cv::Scalar(0, 0, 255));
 
-    draw = img.clone();
+    StreamOutput &output=*outputs[stream];
+    if(!record_file.empty() && !output.record_failed) {
+      const std::string file=RecordFile(record_file, stream, (int)streams.size());
+      const double fps=(streams[stream].fps>0 ? streams[stream].fps : 30);
+      if(!output.record.isOpened() && !output.record.open(file, cv::VideoWriter::fourcc('M','J','P','G'), fps, img.size())) {
+        std::cerr << "Error opening record file " << file << std::endl;
+        output.record_failed=true;
+      } else output.record.write(img);
+    }
+    if(display) {
+      std::lock_guard<std::mutex> lock(output.mutex);
+      img.copyTo(output.shown);
+      output.fresh=true;
+    }
+  });
+  if(!started) return 1;
 
-    locations.clear();
-    hog.detectMultiScale( draw, locations );
-    draw_locations( draw, locations, cv::Scalar(0, 0, 255));
+  // HighGUI stays on this thread; workers only hand over their last frame.
+  while(!scheduler.Wait(std::chrono::milliseconds(display ? 10 : 500))) {
+    if(!display) continue;
+    for(size_t i=0; i<outputs.size(); i++) {
+      std::lock_guard<std::mutex> lock(outputs[i]->mutex);
+      if(!outputs[i]->fresh) continue;
+      imshow(streams.size()==1 ? std::string("cam") : "cam "+std::to_string(i), outputs[i]->shown);
+      outputs[i]->fresh=false;
+    }
+    if(27==(char)cv::waitKey(1)) break;
+  }
+  scheduler.Stop();
 
-    imshow("cam", draw);
-    key = (char)cv::waitKey(10);
-    if(27==key) end_of_process = true;
+  std::cout << "stream\tdecoded\tprocessed\tdropped\tpartial\tlatency_ms\tsource" << std::endl;
+  for(int i=0; i<scheduler.stream_count(); i++) {
+    const StreamStats stats=scheduler.stats(i);
+    std::cout << i << "\t" << stats.decoded << "\t" << stats.processed << "\t" << stats.dropped
+              << "\t" << outputs[i]->partial_frames
+              << "\t" << (stats.processed ? 1000*stats.latency_seconds/stats.processed : 0.0)
+              << "\t" << streams[i].source << std::endl;
+  }
+  if(!cascade_file.empty()) {
+    CascadeCounters total;
+    total.windows=total.blocks=0;
+    for(size_t i=0; i<scratch.size(); i++) {
+      total.windows+=scratch[i].cascade.windows;
+      total.blocks+=scratch[i].cascade.blocks;
+    }
+    std::cout << "cascade scored " << total.windows << " windows, "
+              << (total.windows ? (double)total.blocks/total.windows : 0.0) << " of "
+              << cascade.blocks_x()*cascade.blocks_y() << " blocks each" << std::endl;
   }
 
   return 0;
@@ -0,0 +1,298 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  svmsearch.cpp
+ *
+ *    Description:  Parallel k-fold hyperparameter search over cached features
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 15시 40분 12초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <boost/program_options.hpp>
+#include <boost/algorithm/string.hpp>
+
+#include "feature_file.h"
+#include "linear_svm.h"
+#include "work_stealing.h"
+
+// One point of the grid. Each feature file stands for one HOG setting
+// (window, cell or block size), extracted once by svmtrain.
+struct SearchConfig {
+  int dataset;
+  SvmLoss loss;
+  double C;
+};
+
+struct FoldResult {
+  bool done;
+  double accuracy;
+  double seconds;
+};
+
+struct SearchDataset {
+  std::string path;
+  FeatureMatrix data;
+  std::vector<int> fold_of_row;
+};
+
+// Stratified fold assignment: each label is shuffled and dealt round-robin.
+void AssignFolds(SearchDataset &dataset, int folds, unsigned int seed) {
+  std::vector<int> positives, negatives;
+  for(int i=0; i<dataset.data.rows; i++) {
+    (dataset.data.labels[i]>0 ? positives : negatives).push_back(i);
+  }
+  std::mt19937 random(seed);
+  std::shuffle(positives.begin(), positives.end(), random);
+  std::shuffle(negatives.begin(), negatives.end(), random);
+  dataset.fold_of_row.resize(dataset.data.rows);
+  for(size_t i=0; i<positives.size(); i++) dataset.fold_of_row[positives[i]]=(int)(i%folds);
+  for(size_t i=0; i<negatives.size(); i++) dataset.fold_of_row[negatives[i]]=(int)(i%folds);
+}
+
+FoldResult RunFold(const SearchDataset &dataset, const SearchConfig &config,
+                   const LinearSvmParams &base, int fold) {
+  const std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+  std::vector<int> train_rows, test_rows;
+  std::vector<float> scratch(dataset.data.cols);
+  for(int i=0; i<dataset.data.rows; i++) {
+    (dataset.fold_of_row[i]==fold ? test_rows : train_rows).push_back(i);
+  }
+
+  LinearSvmParams params=base;
+  params.loss=config.loss;
+  params.C=config.C;
+  std::vector<float> detector;
+  TrainLinearSvm(dataset.data, params, detector, 0, &train_rows);
+
+  int correct=0;
+  for(size_t i=0; i<test_rows.size(); i++) {
+    const double score=DecisionValue(detector, dataset.data.row(test_rows[i], scratch.data()), dataset.data.cols);
+    if((score>0)==(dataset.data.labels[test_rows[i]]>0)) correct++;
+  }
+
+  FoldResult result;
+  result.done=true;
+  result.accuracy=(test_rows.empty() ? 0.0 : (double)correct/test_rows.size());
+  result.seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  return result;
+}
+
+double MeanAccuracy(const std::vector<FoldResult> &folds) {
+  double sum=0.0;
+  int count=0;
+  for(size_t i=0; i<folds.size(); i++) {
+    if(!folds[i].done) continue;
+    sum+=folds[i].accuracy;
+    count++;
+  }
+  return count ? sum/count : 0.0;
+}
+
+int DoneFolds(const std::vector<FoldResult> &folds) {
+  int count=0;
+  for(size_t i=0; i<folds.size(); i++) count+=folds[i].done;
+  return count;
+}
+
+double TotalSeconds(const std::vector<FoldResult> &folds) {
+  double sum=0.0;
+  for(size_t i=0; i<folds.size(); i++) if(folds[i].done) sum+=folds[i].seconds;
+  return sum;
+}
+
+// Configurations that survived more halving rungs rank first.
+struct BetterConfig {
+  const std::vector< std::vector<FoldResult> > *results;
+  bool operator()(int a, int b) const {
+    const int done_a=DoneFolds((*results)[a]);
+    const int done_b=DoneFolds((*results)[b]);
+    if(done_a!=done_b) return done_a>done_b;
+    const double accuracy_a=MeanAccuracy((*results)[a]);
+    const double accuracy_b=MeanAccuracy((*results)[b]);
+    if(accuracy_a!=accuracy_b) return accuracy_a>accuracy_b;
+    return a<b;
+  }
+};
+
+int main(int argc, char** argv) {
+  int folds, thread_count;
+  unsigned int seed;
+  std::string strategy;
+  std::string c_list;
+  std::string loss_list;
+  std::string storage_name;
+  FeatureStorage storage;
+  std::vector<std::string> feature_files;
+  LinearSvmParams base;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("source,s", po::value< std::vector<std::string> >(&feature_files)->required(), "Specify feature files, one per HOG setting")
+    ("C,c", po::value<std::string>(&c_list)->default_value("0.001,0.01,0.1,1"), "Specify comma separated C values")
+    ("loss,l", po::value<std::string>(&loss_list)->default_value("hinge,squared_hinge,svr"), "Specify comma separated losses")
+    ("p", po::value<double>(&base.p)->default_value(0.1), "Specify epsilon of the svr loss")
+    ("folds,k", po::value<int>(&folds)->default_value(5), "Specify number of cross-validation folds")
+    ("strategy", po::value<std::string>(&strategy)->default_value("grid"), "Specify grid or halving (successive halving over folds)")
+    ("iterations,i", po::value<int>(&base.max_iterations)->default_value(1000), "Specify the maximum number of solver passes")
+    ("seed", po::value<unsigned int>(&seed)->default_value(1), "Specify the fold shuffling seed")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of worker threads (0 uses every core)")
+    ("storage", po::value<std::string>(&storage_name)->default_value("f32"), "Specify how rows are kept in memory: f32, f16 or q8 (8-bit, one scale per 36 values)");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] features..." << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+    if(folds<2) throw std::invalid_argument("at least 2 folds are needed");
+    if(strategy!="grid" && strategy!="halving") throw std::invalid_argument("unknown strategy "+strategy);
+    if(!ParseFeatureStorage(storage_name, storage)) throw std::invalid_argument("unknown storage "+storage_name);
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  std::vector<double> c_values;
+  std::vector<SvmLoss> losses;
+  {
+    std::vector<std::string> tokens;
+    boost::split(tokens, c_list, boost::is_any_of(","));
+    for(size_t i=0; i<tokens.size(); i++) {
+      double value=0.0;
+      size_t parsed=0;
+      try {
+        value=std::stod(tokens[i], &parsed);
+      }
+      catch(std::exception &) {
+        parsed=0;
+      }
+      if(parsed==0 || parsed!=tokens[i].size() || value<=0) {
+        std::cerr << "Error: bad C value " << tokens[i] << std::endl;
+        return 1;
+      }
+      c_values.push_back(value);
+    }
+    tokens.clear();
+    boost::split(tokens, loss_list, boost::is_any_of(","));
+    for(size_t i=0; i<tokens.size(); i++) {
+      SvmLoss loss;
+      if(!ParseSvmLoss(tokens[i], loss)) {
+        std::cerr << "Error: unknown loss " << tokens[i] << std::endl;
+        return 1;
+      }
+      losses.push_back(loss);
+    }
+  }
+
+  const std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+
+  // Every configuration and fold shares these matrices read-only.
+  std::vector<SearchDataset> datasets(feature_files.size());
+  for(size_t i=0; i<feature_files.size(); i++) {
+    datasets[i].path=feature_files[i];
+    datasets[i].data.storage=storage;
+    if(!ReadFeatureFile(feature_files[i], datasets[i].data) || datasets[i].data.rows<folds) {
+      std::cerr << "Error reading feature file " << feature_files[i] << std::endl;
+      return 1;
+    }
+    AssignFolds(datasets[i], folds, seed);
+    std::cout << "Loaded " << datasets[i].data.rows << " rows of " << datasets[i].data.cols
+              << " features from " << feature_files[i] << " (" << datasets[i].data.memory_bytes()/(1<<20)
+              << " MB as " << FeatureStorageName(storage) << ")" << std::endl;
+  }
+
+  std::vector<SearchConfig> configs;
+  for(size_t d=0; d<datasets.size(); d++) {
+    for(size_t l=0; l<losses.size(); l++) {
+      for(size_t c=0; c<c_values.size(); c++) {
+        SearchConfig config;
+        config.dataset=(int)d;
+        config.loss=losses[l];
+        config.C=c_values[c];
+        configs.push_back(config);
+      }
+    }
+  }
+
+  FoldResult pending;
+  pending.done=false;
+  pending.accuracy=0.0;
+  pending.seconds=0.0;
+  std::vector< std::vector<FoldResult> > results(configs.size(), std::vector<FoldResult>(folds, pending));
+
+  std::vector<int> alive(configs.size());
+  for(size_t i=0; i<configs.size(); i++) alive[i]=(int)i;
+
+  // Grid search evaluates every fold at once. Successive halving evaluates
+  // 1, 2, 4, ... folds per rung and keeps the better half of the survivors,
+  // reusing the folds already run.
+  WorkStealingPool pool(thread_count);
+  BetterConfig better;
+  better.results=&results;
+  int rung_folds=(strategy=="grid" ? folds : 1);
+  for(;;) {
+    std::vector< std::pair<int, int> > tasks;
+    for(size_t i=0; i<alive.size(); i++) {
+      for(int fold=0; fold<rung_folds; fold++) {
+        if(!results[alive[i]][fold].done) tasks.push_back(std::make_pair(alive[i], fold));
+      }
+    }
+    pool.Run((int)tasks.size(), [&](int task, int) {
+      const SearchConfig &config=configs[tasks[task].first];
+      results[tasks[task].first][tasks[task].second]=RunFold(datasets[config.dataset], config, base, tasks[task].second);
+    });
+    std::cout << "Evaluated " << alive.size() << " configurations on " << rung_folds << " folds" << std::endl;
+
+    if(rung_folds==folds || alive.size()<=1) break;
+    std::sort(alive.begin(), alive.end(), better);
+    alive.resize((alive.size()+1)/2);
+    rung_folds=std::min(rung_folds*2, folds);
+  }
+
+  std::vector<int> ranking(configs.size());
+  for(size_t i=0; i<configs.size(); i++) ranking[i]=(int)i;
+  std::sort(ranking.begin(), ranking.end(), better);
+
+  std::cout << std::endl << "accuracy\tfolds\ttrain_s\tloss\tC\tfeatures" << std::endl;
+  for(size_t r=0; r<ranking.size(); r++) {
+    const SearchConfig &config=configs[ranking[r]];
+    std::cout << MeanAccuracy(results[ranking[r]]) << "\t" << DoneFolds(results[ranking[r]]) << "\t" << TotalSeconds(results[ranking[r]])
+              << "\t" << SvmLossName(config.loss) << "\t" << config.C << "\t" << datasets[config.dataset].path << std::endl;
+  }
+
+  const SearchConfig &best=configs[ranking.front()];
+  const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  std::cout << std::endl << "Best: loss=" << SvmLossName(best.loss) << " C=" << best.C
+            << " features=" << datasets[best.dataset].path
+            << " accuracy=" << MeanAccuracy(results[ranking.front()])
+            << " (" << TotalSeconds(results[ranking.front()]) << "s of training)" << std::endl;
+  std::cout << "Search took " << seconds << "s on " << pool.thread_count() << " threads" << std::endl;
+  return 0;
+}
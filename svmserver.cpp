@@ -0,0 +1,364 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  svmserver.cpp
+ *
+ *    Description:  Local detection server sharing warm detectors between processes
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 17시 31분 05초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+#include <opencv2/opencv.hpp>
+
+#include "detection_protocol.h"
+#include "detector_io.h"
+#include "nms.h"
+
+// One client socket and the frame buffers it attached. Jobs hold a
+// reference, so a client that hangs up with requests queued is torn down
+// only after its last reply has been attempted.
+struct Connection {
+  int fd;
+  std::mutex write_mutex;
+  std::map< uint32_t, std::shared_ptr<SharedFrameBuffer> > buffers;
+
+  explicit Connection(int socket_fd) : fd(socket_fd) {}
+  ~Connection() { close(fd); }
+};
+
+struct DetectJob {
+  std::shared_ptr<Connection> connection;
+  std::shared_ptr<SharedFrameBuffer> buffer;
+  DetectRequest request;
+};
+
+// Requests from every connection meet here. The queue holds at most
+// `capacity` jobs: a full queue stalls the connection readers, so a flood
+// pushes back on its clients instead of growing the queue. After Shutdown,
+// Push drops jobs and PopBatch returns false once the queue has drained.
+class JobQueue {
+ public:
+  explicit JobQueue(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)), closed_(false) {}
+
+  void Push(const DetectJob &job) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      space_.wait(lock, [this] { return closed_ || jobs_.size()<capacity_; });
+      if(closed_) return;
+      jobs_.push_back(job);
+    }
+    ready_.notify_one();
+  }
+
+  // Blocks for the oldest job, then takes up to max_jobs-1 more queued jobs
+  // for the same detector in arrival order, so one wake-up runs a detector
+  // over several frames while its weights are warm. Jobs for other
+  // detectors keep their order; one batch delays them by at most max_jobs.
+  bool PopBatch(size_t max_jobs, std::vector<DetectJob> &batch) {
+    batch.clear();
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this] { return closed_ || !jobs_.empty(); });
+      if(jobs_.empty()) return false;
+      const uint32_t detector=jobs_.front().request.detector;
+      std::deque<DetectJob> rest;
+      for(size_t i=0; i<jobs_.size(); i++) {
+        if(batch.size()<max_jobs && jobs_[i].request.detector==detector) batch.push_back(jobs_[i]);
+        else rest.push_back(jobs_[i]);
+      }
+      jobs_.swap(rest);
+    }
+    space_.notify_all();
+    return true;
+  }
+
+  void Shutdown() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_=true;
+    }
+    ready_.notify_all();
+    space_.notify_all();
+  }
+
+ private:
+  std::deque<DetectJob> jobs_;
+  size_t capacity_;
+  bool closed_;
+  std::mutex mutex_;
+  std::condition_variable ready_;
+  std::condition_variable space_;
+};
+
+volatile sig_atomic_t shutdown_requested=0;
+
+void RequestShutdown(int) {
+  shutdown_requested=1;
+}
+
+// Shutdown signals go to main's accept4 only; other threads block them.
+void BlockShutdownSignals() {
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, 0);
+}
+
+// Per-worker scratch so steady-state requests reuse their vectors.
+struct WorkerScratch {
+  std::vector<cv::Rect> locations;
+  std::vector<double> weights;
+  std::vector<ScoredDetection> detections;
+  std::vector<char> reply;
+};
+
+struct ServerDetector {
+  std::string name;
+  cv::HOGDescriptor hog;
+};
+
+int ValidateFrame(const DetectJob &job, int detector_count, cv::Mat &frame) {
+  const DetectRequest &request=job.request;
+  if(!job.buffer) return kUnknownBuffer;
+  if(request.detector>=(uint32_t)detector_count) return kUnknownDetector;
+  if(request.rows<=0 || request.cols<=0 || (request.channels!=1 && request.channels!=3)) return kBadFrame;
+  const uint64_t row_bytes=(uint64_t)request.cols*request.channels;
+  if(request.step<row_bytes) return kBadFrame;
+  const uint64_t span=(uint64_t)(request.rows-1)*request.step+row_bytes;
+  if(request.offset>job.buffer->size() || span>job.buffer->size()-request.offset) return kBadFrame;
+  frame=cv::Mat(request.rows, request.cols, CV_8UC(request.channels), job.buffer->data()+request.offset, request.step);
+  return kDetectionOk;
+}
+
+void RunJob(const DetectJob &job, const std::vector<ServerDetector> &detectors,
+            const NmsParams &nms, WorkerScratch &scratch) {
+  DetectionsReply reply;
+  memset(&reply, 0, sizeof(reply));
+  reply.request_id=job.request.request_id;
+  scratch.detections.clear();
+
+  cv::Mat frame;
+  reply.status=ValidateFrame(job, (int)detectors.size(), frame);
+  if(reply.status==kDetectionOk) {
+    // The frame is a view into the client's shared memory; nothing is copied.
+    scratch.locations.clear();
+    scratch.weights.clear();
+    detectors[job.request.detector].hog.detectMultiScale(frame, scratch.locations, scratch.weights, 0, cv::Size(), cv::Size(), 1.05, 0);
+    ToScoredDetections(scratch.locations, scratch.weights, scratch.detections);
+    SuppressNonMaxima(scratch.detections, nms);
+  }
+  reply.count=(uint32_t)scratch.detections.size();
+
+  scratch.reply.resize(sizeof(reply)+scratch.detections.size()*sizeof(WireDetection));
+  memcpy(&scratch.reply[0], &reply, sizeof(reply));
+  for(size_t i=0; i<scratch.detections.size(); i++) {
+    WireDetection wire;
+    wire.x=scratch.detections[i].box.x;
+    wire.y=scratch.detections[i].box.y;
+    wire.width=scratch.detections[i].box.width;
+    wire.height=scratch.detections[i].box.height;
+    wire.score=scratch.detections[i].score;
+    memcpy(&scratch.reply[sizeof(reply)+i*sizeof(wire)], &wire, sizeof(wire));
+  }
+  std::lock_guard<std::mutex> lock(job.connection->write_mutex);
+  SendMessage(job.connection->fd, kDetectionsMessage, &scratch.reply[0], scratch.reply.size());
+}
+
+// Reads one client's messages until it hangs up. Buffers are mapped here,
+// detect requests are resolved to their buffer and queued.
+void ServeConnection(std::shared_ptr<Connection> connection, std::shared_ptr<JobQueue> queue, std::string hello) {
+  BlockShutdownSignals();
+  {
+    std::lock_guard<std::mutex> lock(connection->write_mutex);
+    if(!SendMessage(connection->fd, kHelloMessage, hello.data(), hello.size())) return;
+  }
+
+  MessageHeader header;
+  std::vector<char> payload;
+  int received_fd;
+  while(ReceiveMessage(connection->fd, header, payload, &received_fd)) {
+    if(header.type==kAttachBufferMessage && payload.size()>=sizeof(AttachBuffer) && received_fd>=0) {
+      AttachBuffer attach;
+      memcpy(&attach, &payload[0], sizeof(attach));
+      std::shared_ptr<SharedFrameBuffer> buffer(new SharedFrameBuffer);
+      if(!buffer->Map(received_fd, attach.size, false)) {
+        std::cerr << "Rejected a frame buffer of " << attach.size << " bytes" << std::endl;
+        continue;
+      }
+      // Only a buffer attached under the same id is replaced; jobs still
+      // queued against it keep it mapped.
+      connection->buffers[attach.buffer_id]=buffer;
+    } else if(header.type==kDetectMessage && payload.size()>=sizeof(DetectRequest)) {
+      DetectJob job;
+      job.connection=connection;
+      memcpy(&job.request, &payload[0], sizeof(job.request));
+      std::map< uint32_t, std::shared_ptr<SharedFrameBuffer> >::const_iterator buffer=connection->buffers.find(job.request.buffer_id);
+      if(buffer!=connection->buffers.end()) job.buffer=buffer->second;
+      queue->Push(job);
+    } else if(received_fd>=0) {
+      close(received_fd);
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  int width, height, thread_count, max_batch, queue_capacity;
+  std::string socket_path;
+  std::string nms_mode;
+  std::vector<std::string> detector_files;
+  NmsParams nms;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("detector,d", po::value< std::vector<std::string> >(&detector_files)->required(), "Specify detector files to serve, addressed by their position")
+    ("socket,s", po::value<std::string>(&socket_path)->default_value("/tmp/svmserver.sock"), "Specify the Unix domain socket to listen on")
+    ("width,w", po::value<int>(&width)->default_value(128), "Specify detector window width")
+    ("height", po::value<int>(&height)->default_value(72), "Specify detector window height")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of detection threads (0 uses every core)")
+    ("batch", po::value<int>(&max_batch)->default_value(8), "Specify the most queued requests for one detector a worker takes at once")
+    ("queue", po::value<int>(&queue_capacity)->default_value(256), "Specify the most requests waiting for a worker before clients are read more slowly")
+    ("nms", po::value<std::string>(&nms_mode)->default_value("greedy"), "Specify greedy or soft non-maximum suppression")
+    ("nms-iou", po::value<double>(&nms.iou_threshold)->default_value(0.3), "Specify the overlap above which greedy NMS suppresses a box")
+    ("soft-sigma", po::value<double>(&nms.sigma)->default_value(0.5), "Specify the Gaussian decay of soft NMS")
+    ("min-score", po::value<double>(&nms.score_threshold)->default_value(0.3), "Specify the score below which soft NMS drops a box");
+
+    po::positional_options_description p;
+    p.add("detector",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] detectors..." << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+    if(!ParseNmsMode(nms_mode, nms.mode)) throw std::invalid_argument("unknown nms mode "+nms_mode);
+    if(max_batch<1) throw std::invalid_argument("batch must be at least 1");
+    if(queue_capacity<1) throw std::invalid_argument("queue must be at least 1");
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  // Detectors are loaded once and shared read-only by every worker.
+  std::vector<ServerDetector> detectors(detector_files.size());
+  std::string hello;
+  {
+    DetectionHello header;
+    header.version=kDetectionProtocolVersion;
+    header.detector_count=(uint32_t)detectors.size();
+    hello.assign((const char *)&header, sizeof(header));
+  }
+  for(size_t i=0; i<detector_files.size(); i++) {
+    std::vector<float> detector;
+    if(!LoadDetector(detector_files[i], detector)) {
+      std::cerr << "Error opening detector " << detector_files[i] << std::endl;
+      return 1;
+    }
+    detectors[i].name=boost::filesystem::path(detector_files[i]).filename().string();
+    detectors[i].hog.winSize=cv::Size(width, height);
+    detectors[i].hog.setSVMDetector(detector);
+    hello+=(i ? "\n" : "")+detectors[i].name;
+    std::cout << "Detector " << i << ": " << detector_files[i] << std::endl;
+  }
+
+  const int listen_fd=ListenUnixSocket(socket_path);
+  if(listen_fd<0) {
+    std::cerr << "Error listening on " << socket_path << ": " << strerror(errno) << std::endl;
+    return 1;
+  }
+
+  // Workers live as long as the server and each pulls the next batch as
+  // soon as it is free, so no request waits for thread start-up or for a
+  // slower one on another worker. Connection threads are detached and
+  // share the queue, so it outlives them; workers are joined before main
+  // returns.
+  if(thread_count<=0) thread_count=(int)std::thread::hardware_concurrency();
+  if(thread_count<=0) thread_count=1;
+  std::shared_ptr<JobQueue> queue(new JobQueue(queue_capacity));
+  std::vector<std::thread> workers;
+  for(int worker=0; worker<thread_count; worker++) {
+    workers.push_back(std::thread([&] {
+      BlockShutdownSignals();
+      WorkerScratch scratch;
+      std::vector<DetectJob> batch;
+      while(queue->PopBatch(max_batch, batch)) {
+        for(size_t i=0; i<batch.size(); i++) RunJob(batch[i], detectors, nms, scratch);
+        batch.clear();  // let closed connections go
+      }
+    }));
+  }
+
+  // SIGINT/SIGTERM interrupt accept4 (no SA_RESTART) and stop the server.
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  action.sa_handler=RequestShutdown;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, 0);
+  sigaction(SIGTERM, &action, 0);
+
+  std::cout << "Serving " << detectors.size() << " detectors on " << socket_path
+            << " with " << thread_count << " threads" << std::endl;
+  int status=0;
+  while(!shutdown_requested) {
+    const int client_fd=accept4(listen_fd, 0, 0, SOCK_CLOEXEC);
+    if(client_fd<0) {
+      if(errno==EINTR || errno==ECONNABORTED) continue;
+      if(errno==EMFILE || errno==ENFILE || errno==ENOBUFS || errno==ENOMEM) {
+        // Out of descriptors or memory for now; clients leaving frees them.
+        std::cerr << "Warning: cannot accept a client yet: " << strerror(errno) << std::endl;
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+      std::cerr << "Error accepting a client: " << strerror(errno) << std::endl;
+      status=1;
+      break;
+    }
+    std::shared_ptr<Connection> connection(new Connection(client_fd));
+    std::thread(ServeConnection, connection, queue, hello).detach();
+  }
+
+  std::cout << "Shutting down" << std::endl;
+  queue->Shutdown();
+  for(size_t i=0; i<workers.size(); i++) workers[i].join();
+  close(listen_fd);
+  unlink(socket_path.c_str());
+  return status;
+}
@@ -16,18 +16,28 @@
  * =====================================================================================
  */
 #include <vector>
+#include <atomic>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <set>
 #include <opencv/cv.hpp>
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/foreach.hpp>
+
+#include "compact_detector.h"
+#include "dataset_manifest.h"
+#include "extraction_checkpoint.h"
+#include "feature_shard.h"
+#include "hog_flip.h"
+#include "video_scheduler.h"
+#include "work_stealing.h"
 
 const cv::Size kTrainingPadding = cv::Size(0, 0);
 const cv::Size kWinStride = cv::Size(8,8);
 
-void CalculateFeaturesFromInput(const cv::Mat &image_data, std::vector<float>& feature_vector, cv::HOGDescriptor& hog) {
+void CalculateFeaturesFromInput(const cv::Mat &image_data, std::vector<float>& feature_vector, const cv::HOGDescriptor& hog) {
   if (image_data.empty()) {
     feature_vector.clear();
     std::cerr << "Error: HOG image is empty, features calculation skipped!" << std::endl;
@@ -44,20 +54,56 @@ void CalculateFeaturesFromInput(const cv::Mat &image_data, std::vector<float>& f
 }
 
 void PopulateWithVideoPath(const std::string &folder_name, std::vector<std::string> &videos) {
-  boost::filesystem::path current_dir(boost::filesystem::current_path().string<std::string>()
-                                      +"/"+folder_name);
-  if(!boost::filesystem::is_directory(current_dir)) return;
+  ListVideoFiles(folder_name, videos);
+}
 
-  boost::filesystem::directory_iterator dir_iter(current_dir), eod;
+// Filters the parallel per-video lists down to the entries marked in keep.
+void KeepVideos(const std::vector<char> &keep,
+                std::vector<std::string> &videos,
+                std::vector<int> &labels,
+                std::vector<int> &frame_counts,
+                std::vector<std::string> &hashes) {
+  size_t kept=0;
+  for(size_t i=0; i<videos.size(); i++) {
+    if(!keep[i]) continue;
+    videos[kept]=videos[i];
+    labels[kept]=labels[i];
+    if(!frame_counts.empty()) frame_counts[kept]=frame_counts[i];
+    if(!hashes.empty()) hashes[kept]=hashes[i];
+    kept++;
+  }
+  videos.resize(kept);
+  labels.resize(kept);
+  if(!frame_counts.empty()) frame_counts.resize(kept);
+  if(!hashes.empty()) hashes.resize(kept);
+}
 
-  BOOST_FOREACH(boost::filesystem::path const &file_path, std::make_pair(dir_iter, eod)) {
-    videos.push_back(file_path.string<std::string>());
+void AppendFeatureRow(std::ostream &buffer, bool positive, const std::vector<float> &features) {
+  buffer << (positive ? "+1" : "-1");
+  for(int feature_index=0; feature_index<(int)features.size(); feature_index++) {
+    buffer << " " << (feature_index+1) << ":" << features[feature_index];
   }
+  buffer << "\n";
 }
 
+// Feature rows of one segment, formatted off the writer thread.
+struct SegmentRows {
+  std::string text;
+  int frames;
+  int rows;  // frames plus any mirrored copies
+  int feature_count;
+};
+
 int main ( int argc, const char * argv[] ) {
-  int width, height;
+  int width, height, thread_count, segment_frames, frames_per_video, cell_size;
   std::string output_file;
+  std::string descriptor_name;
+  std::string projection_file;
+  DescriptorMode descriptor;
+  std::string manifest_file;
+  std::string shard_spec;
+  Shard shard;
+  bool luma, flip, use_checkpoint;
   std::string positive_source_directory;
   std::string negative_source_directory;
 
@@ -70,7 +116,18 @@ int main ( int argc, const char * argv[] ) {
     ("height,h", po::value<int>(&height)->default_value(72), "Specify train window height")
     ("positive,p", po::value<std::string>(&positive_source_directory)->default_value(boost::filesystem::current_path().string<std::string>()+"/positive"), "Specify positive video files directory")
     ("negative,n", po::value<std::string>(&negative_source_directory)->default_value(boost::filesystem::current_path().string<std::string>()+"/negative"), "Specify negative video files direcotry")
-    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/feature.data"), "Specify an output file");
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/feature.data"), "Specify an output file")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of worker threads (0 uses every core)")
+    ("segment", po::value<int>(&segment_frames)->default_value(kDefaultSegmentFrames), "Specify frames per scheduling segment (0 keeps videos whole)")
+    ("frames-per-video", po::value<int>(&frames_per_video)->default_value(0), "Specify evenly spaced frames to sample per video (0 uses every frame)")
+    ("luma", po::value<bool>(&luma)->default_value(false), "Specify whether to compute HOG on the decoder's luma plane instead of BGR frames")
+    ("flip", po::value<bool>(&flip)->default_value(false), "Specify whether to add a mirrored row after every positive row")
+    ("descriptor", po::value<std::string>(&descriptor_name)->default_value("hog"), "Specify the descriptor: hog, fhog (31 values per cell) or pca (HOG blocks through --projection)")
+    ("cell", po::value<int>(&cell_size)->default_value(8), "Specify the fhog cell size in pixels")
+    ("projection", po::value<std::string>(&projection_file), "Specify a block projection from featurepca for the pca descriptor")
+    ("manifest,m", po::value<std::string>(&manifest_file), "Specify a dataset manifest from videoindex instead of scanning directories")
+    ("shard", po::value<std::string>(&shard_spec), "Specify i/N to extract only shard i of N into <output>.shard-i-of-N; combine shards with featuremerge")
+    ("checkpoint", po::value<bool>(&use_checkpoint)->default_value(true), "Specify whether to journal finished segments in <output>.ckpt and resume from it after a crash");
 
     po::variables_map vm;
     po::store(po::command_line_parser(argc,argv).options(desc).run(), vm);
@@ -82,6 +139,9 @@ int main ( int argc, const char * argv[] ) {
     }
 
     po::notify(vm);
+    if(!shard_spec.empty()) shard=ParseShard(shard_spec);
+    if(!ParseDescriptorMode(descriptor_name, descriptor)) throw std::invalid_argument("unknown descriptor "+descriptor_name);
+    if(descriptor==kPcaDescriptor && projection_file.empty()) throw std::invalid_argument("the pca descriptor needs --projection");
   }
   catch(std::exception& e) {
     std::cerr << "Error: " << e.what() << std::endl;
@@ -97,55 +157,230 @@ int main ( int argc, const char * argv[] ) {
   // hog.blockStride=cv::Size(8,8);
   // hog.cellSize=cv::Size(8,8);
 
-  // Get the files to train from somewhere
-  std::vector<std::string> positive_training_sample_videos;
-  std::vector<std::string> negative_training_sample_videos;
+  BlockProjection projection;
+  if(descriptor==kPcaDescriptor) {
+    if(!LoadBlockProjection(projection_file, projection)) {
+      std::cerr << "Error opening projection " << projection_file << std::endl;
+      return 1;
+    }
+    if(hog.getDescriptorSize()%projection.block_values) {
+      std::cerr << "Error: projection expects blocks of " << projection.block_values << " values" << std::endl;
+      return 1;
+    }
+  }
+  if(descriptor==kFhogDescriptor && FhogDescriptorSize(hog.winSize, cell_size)==0) {
+    std::cerr << "Error: window is too small for " << cell_size << " pixel fhog cells" << std::endl;
+    return 1;
+  }
 
-  PopulateWithVideoPath("positive",positive_training_sample_videos);
-  PopulateWithVideoPath("negative",negative_training_sample_videos);
+  // Mirroring permutes the raw descriptor; pca rows are projected after.
+  std::vector<int> flip_table;
+  if(flip && !(descriptor==kFhogDescriptor ? BuildFhogFlipTable(hog.winSize, cell_size, flip_table) : BuildHogFlipTable(hog, flip_table))) {
+    std::cerr << "Error: descriptor geometry is not mirror symmetric, cannot flip" << std::endl;
+    return 1;
+  }
 
+  // Get the files to train from somewhere
   std::vector<std::string> videos;
-  videos.insert(videos.end(), positive_training_sample_videos.begin(), positive_training_sample_videos.end());
-  videos.insert(videos.end(), negative_training_sample_videos.begin(), negative_training_sample_videos.end());
+  std::vector<int> labels;
+  std::vector<int> frame_counts;
+  std::vector<std::string> hashes;
 
-  std::ofstream feature_data;
-  feature_data.open(output_file.c_str(), std::ios::out|std::ios::app);
+  if(!manifest_file.empty()) {
+    std::vector<ManifestEntry> entries;
+    if(!LoadManifest(manifest_file, entries)) {
+      std::cerr << "Error opening manifest " << manifest_file << std::endl;
+      return 1;
+    }
+    // Positives first so labels line up with a directory scan.
+    for(int label=+1; label>=-1; label-=2) {
+      for(size_t i=0; i<entries.size(); i++) {
+        const ManifestEntry &entry=entries[i];
+        if(entry.label!=label) continue;
+        std::string hash=entry.hash;
+        if(!IsUnchanged(entry)) {
+          std::cerr << "Warning: " << entry.path << " changed since it was indexed" << std::endl;
+          hash=ContentHash(entry.path);
+        }
+        videos.push_back(entry.path);
+        labels.push_back(label);
+        frame_counts.push_back(entry.frame_count);
+        hashes.push_back(hash);
+      }
+    }
+  } else {
+    PopulateWithVideoPath(positive_source_directory,videos);
+    labels.assign(videos.size(), +1);
+    PopulateWithVideoPath(negative_source_directory,videos);
+    labels.resize(videos.size(), -1);
+  }
+
+  // Every shard process sees the same full list and keeps its own part.
+  if(!shard_spec.empty()) {
+    std::vector<char> owned;
+    AssignShard(shard, frame_counts, (int)videos.size(), owned);
+    output_file=ShardFeatureFile(output_file, shard);
+    std::cout << "Shard " << shard.index << "/" << shard.count << " writing " << output_file << std::endl;
+    KeepVideos(owned, videos, labels, frame_counts, hashes);
+  }
+
+  // Videos whose rows are already in the output are skipped.
+  if(!hashes.empty()) {
+    std::set<std::string> extracted;
+    LoadExtractedHashes(output_file, extracted);
+    std::vector<char> pending(videos.size(), 1);
+    for(size_t i=0; i<videos.size(); i++) {
+      if(!extracted.count(hashes[i])) continue;
+      std::cout << "Skipping unchanged video " << videos[i] << std::endl;
+      pending[i]=0;
+    }
+    KeepVideos(pending, videos, labels, frame_counts, hashes);
+  }
 
-  std::vector<double> results;
   typedef std::vector<float> FeatureSet;
 
+  std::vector<VideoSegment> segments;
+  if(!manifest_file.empty()) PlanVideoSegments(frame_counts, segment_frames, segments, frames_per_video);
+  else PlanVideoSegments(videos, segment_frames, segments, frames_per_video);
+
+  // Rows past the last journaled segment belong to a segment that never
+  // finished; Open cuts them off before anything is appended.
+  ExtractionCheckpoint checkpoint;
+  std::vector<std::string> video_keys(videos);
+  if(use_checkpoint) {
+    if(!checkpoint.Open(output_file, shard_spec.empty() ? std::string() : ShardRunsFile(output_file))) {
+      std::cerr << "Error opening checkpoint " << CheckpointPath(output_file) << std::endl;
+      return 1;
+    }
+    if(!hashes.empty()) video_keys=hashes;
+
+    std::vector<int> planned_done(videos.size(), 0);
+    std::vector<VideoSegment> pending;
+    for(size_t i=0; i<segments.size(); i++) {
+      if(checkpoint.IsDone(video_keys[segments[i].video_index], segments[i])) planned_done[segments[i].video_index]++;
+      else pending.push_back(segments[i]);
+    }
+    for(size_t i=0; i<videos.size(); i++) {
+      if(checkpoint.RecordedSegments(video_keys[i])>planned_done[i]) {
+        std::cerr << "Error: " << videos[i] << " was checkpointed with different --segment or --frames-per-video settings" << std::endl;
+        return 1;
+      }
+    }
+    if(pending.size()<segments.size()) {
+      std::cout << "Resuming after " << segments.size()-pending.size() << " finished segments ("
+                << checkpoint.done_rows() << " rows in the checkpoint)" << std::endl;
+    }
+    segments.swap(pending);
+  }
+
+  std::ofstream feature_data;
+  feature_data.open(output_file.c_str(), std::ios::out|std::ios::app);
+  {
+    long long planned_frames=0;
+    for(size_t i=0; i<segments.size(); i++) planned_frames+=std::max(SegmentFrameCount(segments[i]), 0);
+    std::cout << "Planned " << segments.size() << " segments over " << videos.size()
+              << " videos (at least " << planned_frames << " frames)" << std::endl;
+  }
+
+  // Segments run out of order across workers; rows are written back in
+  // segment order so the output matches a sequential run.
   int current_frame=0;
-  for(int video_index=0; video_index<(int)videos.size(); video_index++) {
-    const std::string &video_path=(videos[video_index]);
-    std::cout << "Processing video " << video_path << std::endl;
-    cv::VideoCapture video(video_path);
-    if(!video.isOpened()) continue;
-
-    cv::Mat frame;
-    FeatureSet features;
-    while(video.read(frame)) {
-      cv::Mat resized_frame;
+  bool report_features=false;
+  std::atomic<bool> checkpoint_failed(false);
+  // Workers stay within a few segments of the writer, so finished rows do
+  // not pile up in memory and checkpoints follow the work closely.
+  WorkStealingPool pool(thread_count);
+  OrderedEmitter<SegmentRows> emitter([&](int task, SegmentRows &rows) {
+    if(checkpoint_failed) return;  // later rows could not be resumed safely
+    const VideoSegment &segment=segments[task];
+    const bool first_segment=(task==0 || segments[task-1].video_index!=segment.video_index);
+    const bool last_segment=(task+1==(int)segments.size() || segments[task+1].video_index!=segment.video_index);
+    if(first_segment) std::cout << "Processing video " << videos[segment.video_index] << std::endl;
+    if(!report_features && rows.frames>0) {
+      std::cout << "Number of features: " << rows.feature_count << std::endl;
+      report_features=true;
+    }
+    feature_data << rows.text;
+    current_frame+=rows.frames;
+    std::cout << current_frame << " frames processed..." << std::endl;
+    if(!shard_spec.empty()) {
+      ShardRun run;
+      run.label=labels[segment.video_index];
+      run.video_path=videos[segment.video_index];
+      run.rows=rows.rows;
+      feature_data.flush();
+      AppendShardRun(output_file, run);
+    }
+    if(use_checkpoint) {
+      feature_data.flush();
+      if(!feature_data || !checkpoint.Commit(video_keys[segment.video_index], segment, rows.rows)) {
+        std::cerr << "Error: could not checkpoint " << videos[segment.video_index] << std::endl;
+        checkpoint_failed=true;
+      }
+    }
+    if(last_segment && !hashes.empty()) {
+      feature_data.flush();
+      AppendExtractedHash(output_file, hashes[segment.video_index]);
+    }
+  }, 4*pool.thread_count());
+
+  pool.Run((int)segments.size(), [&](int task, int) {
+    emitter.Wait(task);
+    const VideoSegment &segment=segments[task];
+    const bool positive=(labels[segment.video_index]>0);
+
+    SegmentRows rows;
+    rows.frames=0;
+    rows.rows=0;
+    rows.feature_count=0;
+    if(checkpoint_failed) {
+      // Nothing more will be written, so skip the decoding; the empty result
+      // still keeps the emitter moving.
+      emitter.Complete(task, rows);
+      return;
+    }
+    std::ostringstream buffer;
+    cv::Mat resized_frame;
+    FeatureSet features, flipped, projected;
+    ReadVideoSegment(videos[segment.video_index], segment, [&](const cv::Mat &frame, int) {
       cv::resize(frame, resized_frame, hog.winSize);
 
       features.clear();
-      CalculateFeaturesFromInput(resized_frame, features, hog);
+      if(descriptor==kFhogDescriptor) ComputeFhogDescriptor(resized_frame, cell_size, features);
+      else CalculateFeaturesFromInput(resized_frame, features, hog);
 
-      static bool report_features=false;
-      if(!report_features) {
-        std::cout << "Number of features: " << features.size() << std::endl;
-        report_features=true;
+      // Mirrored positives come from permuting the descriptor, not from
+      // flipping the frame and running HOG again.
+      const bool mirror=(positive && !flip_table.empty() && flip_table.size()==features.size());
+      if(mirror) {
+        flipped.resize(features.size());
+        FlipHogDescriptor(&features[0], &flipped[0], flip_table);
+      }
+      if(descriptor==kPcaDescriptor && !features.empty()) {
+        const int blocks=(int)features.size()/projection.block_values;
+        projected.resize((size_t)blocks*projection.components);
+        ProjectBlocks(projection, &features[0], blocks, &projected[0]);
+        features.swap(projected);
+        if(mirror) {
+          projected.resize(features.size());
+          ProjectBlocks(projection, &flipped[0], blocks, &projected[0]);
+          flipped.swap(projected);
+        }
       }
 
-      feature_data << (video_index<(int)positive_training_sample_videos.size() ? "+1" : "-1");
-
-      for(int feature_index=0; feature_index<(int)features.size(); feature_index++) {
-        feature_data << " " << (feature_index+1) << ":" << features[feature_index];
+      AppendFeatureRow(buffer, positive, features);
+      rows.rows++;
+      if(mirror) {
+        AppendFeatureRow(buffer, true, flipped);
+        rows.rows++;
       }
-      feature_data << std::endl;
 
-      std::cout << ++current_frame << " frames processed..." << std::endl;
-    }
-  }
+      rows.feature_count=(int)features.size();
+      rows.frames++;
+    }, luma ? kLumaFrames : kBgrFrames);
+    rows.text=buffer.str();
+    emitter.Complete(task, rows);
+  });
 
-  return 0;
+  return checkpoint_failed ? 1 : 0;
 }
@@ -22,11 +22,21 @@
 #include <fstream>
 #include <vector>
 
-#include <time.h>
+#include <random>
+#include <chrono>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
-#include <boost/foreach.hpp>
+
+#include "dataset_manifest.h"
+#include "detector_io.h"
+#include "feature_file.h"
+#include "hog_flip.h"
+#include "linear_svm.h"
+#include "pyramid_detector.h"
+#include "window_sampler.h"
+#include "video_scheduler.h"
+#include "work_stealing.h"
 
 using namespace cv;
 using namespace cv::ml;
@@ -34,13 +44,41 @@ using namespace std;
 
 void get_svm_detector(const Ptr<SVM>& svm, vector< float > & hog_detector );
 void convert_to_ml(const std::vector< cv::Mat > & train_samples, cv::Mat& trainData );
-void load_images( const string & directory, vector< Mat > & img_lst, const Size & size=Size(0,0) );
-void sample_neg( const vector< Mat > & full_neg_lst, vector< Mat > & neg_lst, const Size & size );
+void list_videos( const string & directory, const string & manifest_file, int label, vector< string > & videos, vector< int > & frame_counts );
+void load_images( const vector< string > & videos, const vector< int > & frame_counts, vector< Mat > & img_lst, const Size & size=Size(0,0), int thread_count=0, int frames_per_video=0, FrameFormat format=kBgrFrames );
+
+/*
+* Where descriptors go as they are computed: float Mats for OpenCV's SVM, or
+* rows encoded straight into a compact FeatureMatrix, so the f16/q8 paths
+* never hold the float set. With a flip table every positive is followed by
+* its mirror, a permutation of the descriptor just computed.
+*/
+struct DescriptorSink
+{
+    FeatureStorage storage;
+    vector< Mat > gradient_lst;  // kFloat32Storage only
+    FeatureMatrix data;          // compact storages only
+    vector< int > labels;
+    vector< int > flip_table;
+    vector< float > flipped;
+
+    explicit DescriptorSink( FeatureStorage storage_ ) : storage( storage_ ) { data.storage = storage_; }
+
+    void add( const float * values, int count, int label );
+    size_t size() const { return labels.size(); }
+
+private:
+    void append( const float * values, int count, int label );
+};
+
+void sample_negatives( const vector< string > & videos, const vector< int > & frame_counts, DescriptorSink & sink, const Size & size, int per_frame=1, unsigned int seed=1, int thread_count=0, int frames_per_video=0, FrameFormat format=kBgrFrames );
 Mat get_hogdescriptor_visu(const Mat& color_origImg, vector<float>& descriptorValues, const Size & size );
-void compute_hog( const vector< Mat > & img_lst, vector< Mat > & gradient_lst, const Size & size );
-void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels, const string & output_file );
+void compute_hog( const vector< Mat > & img_lst, DescriptorSink & sink, const Size & size );
+bool set_flip( DescriptorSink & sink, const Size & size );
+void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels, const string & output_file, double C=0.01, double p=0.1 );
+void train_packed_svm( const FeatureMatrix & data, const string & output_file, double C=0.01, double p=0.1 );
 void draw_locations( Mat & img, const vector< Rect > & locations, const Scalar & color );
-void test_it( const string & output_file, int video_source, const Size & size );
+void test_it( const string & output_file, int video_source, const Size & size, double deadline_ms=0 );
 
 void get_svm_detector(const Ptr<SVM>& svm, vector< float > & hog_detector )
 {
@@ -92,71 +130,103 @@ void convert_to_ml(const std::vector< cv::Mat > & train_samples, cv::Mat& trainD
     }
 }
 
-void load_images( const string & directory, vector< Mat > & img_lst, const Size & size )
+/*
+* Collect the videos of one label, from a dataset manifest when given so that
+* frame counts are known up front, otherwise by scanning the directory.
+*/
+void list_videos( const string & directory, const string & manifest_file, int label, vector< string > & videos, vector< int > & frame_counts )
 {
-  boost::filesystem::path current_dir(directory);
-  if(!boost::filesystem::is_directory(current_dir)) return;
-
-  boost::filesystem::directory_iterator dir_iter(current_dir), eod;
-
-  vector<string> videos;
-  BOOST_FOREACH(boost::filesystem::path const &file_path, std::make_pair(dir_iter, eod)) {
-    videos.push_back(file_path.string<string>());
+  if( manifest_file.empty() ) {
+    ListVideoFiles(directory, videos);
+    return;
   }
+  vector< ManifestEntry > entries;
+  if( !LoadManifest(manifest_file, entries) ) {
+    cerr << "Unable to open manifest " << manifest_file << endl;
+    exit( -1 );
+  }
+  SelectVideos(entries, label, videos, frame_counts);
+}
 
-  for(vector<string>::iterator iter=videos.begin();
-      iter!=videos.end();
-      iter++) {
-    const string &video_path=(*iter);
-    cout << "Loading " << video_path << "..." << endl;
-    cv::VideoCapture video(video_path);
-    if(!video.isOpened()) continue;
-    cv::Mat frame;
-    int frame_count=0;
-    while(video.read(frame)) {
-      if(frame.empty()) break;
-
+void load_images( const vector< string > & videos, const vector< int > & frame_counts, vector< Mat > & img_lst, const Size & size, int thread_count, int frames_per_video, FrameFormat format )
+{
+  vector<VideoSegment> segments;
+  if(frame_counts.size()==videos.size()&&!videos.empty()) PlanVideoSegments(frame_counts, kDefaultSegmentFrames, segments, frames_per_video);
+  else PlanVideoSegments(videos, kDefaultSegmentFrames, segments, frames_per_video);
+
+  size_t planned_frames=0;
+  for(size_t i=0; i<segments.size(); i++) planned_frames+=std::max(SegmentFrameCount(segments[i]), 0);
+  img_lst.reserve(img_lst.size()+planned_frames);
+
+  // Frames are appended in segment order regardless of which worker decoded
+  // them, so img_lst is identical to a sequential load.
+  int frame_count=0;
+  WorkStealingPool pool(thread_count);
+  OrderedEmitter< vector< Mat > > emitter([&](int task, vector< Mat > & frames) {
+    if(task==0||segments[task-1].video_index!=segments[task].video_index) cout << "Loading " << videos[segments[task].video_index] << "..." << endl;
+    img_lst.insert(img_lst.end(), frames.begin(), frames.end());
+    frame_count+=(int)frames.size();
+    cout << "Loaded " << frame_count << " frames." << endl;
+  }, 4*pool.thread_count());
+
+  pool.Run((int)segments.size(), [&](int task, int) {
+    emitter.Wait(task);
+    vector< Mat > frames;
+    ReadVideoSegment(videos[segments[task].video_index], segments[task], [&](const Mat & frame, int) {
       Mat cloned_img;
       if(size.width==0||size.height==0) {
         cloned_img=frame.clone();
       } else resize(frame, cloned_img, size);
+      frames.push_back( cloned_img );
+    }, format);
+    emitter.Complete(task, frames);
+  });
 #ifdef _DEBUG
-      imshow( "image", cloned_img );
-      waitKey( 10 );
-#endif
-      img_lst.push_back( cloned_img );
-      cout << "Loaded " << ++frame_count << " frames." << endl;
-    }
+  for(vector< Mat >::const_iterator img=img_lst.begin(); img!=img_lst.end(); ++img) {
+    imshow( "image", *img );
+    waitKey( 10 );
   }
+#endif
 }
 
-void sample_neg( const vector< Mat > & full_neg_lst, vector< Mat > & neg_lst, const Size & size )
+void sample_negatives( const vector< string > & videos, const vector< int > & frame_counts, DescriptorSink & sink, const Size & size, int per_frame, unsigned int seed, int thread_count, int frames_per_video, FrameFormat format )
 {
-  Rect box;
-  box.width = size.width;
-  box.height = size.height;
-
-  const int size_x = box.width;
-  const int size_y = box.height;
-
-  srand( (unsigned int)time( NULL ) );
-
-  vector< Mat >::const_iterator img = full_neg_lst.begin();
-  vector< Mat >::const_iterator end = full_neg_lst.end();
-
-  int sampled_frames=0;
-  for( ; img != end ; ++img )
-  {
-    box.x = rand() % (img->cols - size_x);
-    box.y = rand() % (img->rows - size_y);
-    Mat roi = (*img)(box);
-    neg_lst.push_back( roi.clone() );
-#ifdef _DEBUG
-    imshow( "img", roi.clone() );
-    waitKey( 10 );
-#endif
-    cout << "Sampled " << ++sampled_frames << " frames." << endl;
-  }
+  vector<VideoSegment> segments;
+  if(frame_counts.size()==videos.size()&&!videos.empty()) PlanVideoSegments(frame_counts, kDefaultSegmentFrames, segments, frames_per_video);
+  else PlanVideoSegments(videos, kDefaultSegmentFrames, segments, frames_per_video);
+
+  HOGDescriptor hog;
+  hog.winSize = size;
+  const size_t descriptor_size = hog.getDescriptorSize();
+
+  // Windows are drawn while decoding, so full frames are never stored, and
+  // each frame's K windows come from one HOG call. A segment's descriptors
+  // go to the sink back to back, in segment order.
+  int sampled=0;
+  WorkStealingPool pool(thread_count);
+  OrderedEmitter< vector< float > > emitter([&](int task, vector< float > & descriptors) {
+    if(task==0||segments[task-1].video_index!=segments[task].video_index) cout << "Sampling " << videos[segments[task].video_index] << "..." << endl;
+    const size_t windows = descriptors.size() / descriptor_size;
+    for( size_t i = 0 ; i < windows ; ++i )
+      sink.add( &descriptors[i*descriptor_size], (int)descriptor_size, -1 );
+    sampled+=(int)windows;
+    cout << "Sampled " << sampled << " windows." << endl;
+  }, 4*pool.thread_count());
+
+  pool.Run((int)segments.size(), [&](int task, int) {
+    emitter.Wait(task);
+    vector< float > descriptors;
+    vector< Point > locations;
+    vector< float > values;
+    Mat gray;
+    ReadVideoSegment(videos[segments[task].video_index], segments[task], [&](const Mat & frame, int frame_index) {
+      mt19937 random = FrameRandom( seed, segments[task].video_index, frame_index );
+      PickWindows( frame.size(), size, hog.blockStride, per_frame, random, locations );
+      ComputeWindowDescriptors( hog, frame, locations, values, gray );
+      descriptors.insert( descriptors.end(), values.begin(), values.begin() + ( values.size() / descriptor_size ) * descriptor_size );
+    }, format);
+    emitter.Complete(task, descriptors);
+  });
 }
 
 // From http://www.juergenwiki.de/work/wiki/doku.php?id=public:hog_descriptor_computation_and_visualization
@@ -318,7 +388,7 @@ Mat get_hogdescriptor_visu(const Mat& color_origImg, vector<float>& descriptorVa
 
 } // get_hogdescriptor_visu
 
-void compute_hog( const vector< Mat > & img_lst, vector< Mat > & gradient_lst, const Size & size )
+void compute_hog( const vector< Mat > & img_lst, DescriptorSink & sink, const Size & size )
 {
     HOGDescriptor hog;
     hog.winSize = size;
@@ -329,9 +399,11 @@ void compute_hog( const vector< Mat > & img_lst, vector< Mat > & gradient_lst, c
     vector< Mat >::const_iterator img = img_lst.begin();
     vector< Mat >::const_iterator end = img_lst.end();
     for( ; img != end ; ++img ) {
-        cvtColor( *img, gray, COLOR_BGR2GRAY );
+        // Luma-loaded frames are already single channel.
+        if( img->channels() == 1 ) gray = *img;
+        else cvtColor( *img, gray, COLOR_BGR2GRAY );
         hog.compute( gray, descriptors, Size( 8, 8 ), Size( 0, 0 ), location );
-        gradient_lst.push_back( Mat( descriptors ).clone() );
+        sink.add( descriptors.data(), (int)descriptors.size(), +1 );
 #ifdef _DEBUG
         imshow( "gradient", get_hogdescriptor_visu( img->clone(), descriptors, size ) );
         waitKey( 10 );
@@ -339,7 +411,43 @@ void compute_hog( const vector< Mat > & img_lst, vector< Mat > & gradient_lst, c
     }
 }
 
-void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels , const string & output_file )
+bool set_flip( DescriptorSink & sink, const Size & size )
+{
+    // Same descriptor layout as compute_hog, so the mirrored positives are
+    // a fixed permutation of the ones computed.
+    HOGDescriptor hog;
+    hog.winSize = size;
+    if( BuildHogFlipTable( hog, sink.flip_table ) ) return true;
+    cerr << "HOG geometry is not mirror symmetric, skipping flip" << endl;
+    return false;
+}
+
+void DescriptorSink::add( const float * values, int count, int label )
+{
+    append( values, count, label );
+    if( label <= 0 || flip_table.empty() || (size_t)count != flip_table.size() ) return;
+    flipped.resize( count );
+    FlipHogDescriptor( values, flipped.data(), flip_table );
+    append( flipped.data(), count, +1 );
+}
+
+void DescriptorSink::append( const float * values, int count, int label )
+{
+    labels.push_back( label );
+    if( storage == kFloat32Storage )
+    {
+        gradient_lst.push_back( Mat( 1, count, CV_32FC1, (void *)values ).clone() );
+        return;
+    }
+    if( data.rows == 0 ) data.cols = count;
+    CV_Assert( count == data.cols );
+    data.packed.resize( (size_t)( data.rows + 1 ) * data.row_bytes() );
+    EncodeRow( storage, values, count, data.packed_row( data.rows ) );
+    data.labels.push_back( (float)label );
+    data.rows++;
+}
+
+void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels , const string & output_file, double C, double p )
 {
 
     Mat train_data;
@@ -354,8 +462,8 @@ void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels
     svm->setGamma(0);
     svm->setKernel(SVM::LINEAR);
     svm->setNu(0.5);
-    svm->setP(0.1); // for EPSILON_SVR, epsilon in loss function?
-    svm->setC(0.01); // From paper, soft classifier
+    svm->setP(p); // for EPSILON_SVR, epsilon in loss function?
+    svm->setC(C); // From paper, soft classifier, tune with svmsearch
     svm->setType(SVM::EPS_SVR); // C_SVC; // EPSILON_SVR; // may be also NU_SVR; // do regression task
     svm->train(train_data, ROW_SAMPLE, Mat(labels));
     clog << "...[done]" << endl;
@@ -363,6 +471,30 @@ void train_svm( const vector< Mat > & gradient_lst, const vector< int > & labels
     svm->save( output_file );
 }
 
+/*
+* The same epsilon-SVR problem train_svm hands OpenCV, solved by the linear
+* dual coordinate descent that decodes compact rows as it visits them. The
+* result is written as a plain detector.
+*/
+void train_packed_svm( const FeatureMatrix & data, const string & output_file, double C, double p )
+{
+    LinearSvmParams params;
+    params.loss = kEpsilonInsensitiveLoss;
+    params.C = C;
+    params.p = p;
+    vector< float > detector;
+
+    clog << "Start training on " << data.memory_bytes() / (1 << 20) << " MB of " << FeatureStorageName( data.storage ) << " rows...";
+    TrainLinearSvm( data, params, detector );
+    clog << "...[done]" << endl;
+
+    if( !SaveDetector( output_file, detector ) )
+    {
+        cerr << "Unable to write detector " << output_file << endl;
+        exit( -1 );
+    }
+}
+
 void draw_locations( Mat & img, const vector< Rect > & locations, const Scalar & color )
 {
     if( !locations.empty() )
@@ -376,23 +508,27 @@ void draw_locations( Mat & img, const vector< Rect > & locations, const Scalar &
     }
 }
 
-void test_it( const string & output_file, int video_source, const Size & size )
+void test_it( const string & output_file, int video_source, const Size & size, double deadline_ms )
 {
     char key = 27;
     Scalar reference( 0, 255, 0 );
     Scalar trained( 0, 0, 255 );
-    Mat img, draw;
+    Mat img;
     Ptr<SVM> svm;
     HOGDescriptor hog;
     hog.winSize = size;
     VideoCapture video;
     vector< Rect > locations;
+    vector< ScoredDetection > detections;
+    DeadlinePyramid pyramid;
 
-    // Load the trained SVM.
-    svm = StatModel::load<SVM>( output_file );
-    // Set the trained svm to hog
+    // Load the trained SVM; compact-storage training writes a plain detector.
     vector< float > hog_detector;
-    get_svm_detector( svm, hog_detector );
+    if( !LoadDetector( output_file, hog_detector ) )
+    {
+        svm = StatModel::load<SVM>( output_file );
+        get_svm_detector( svm, hog_detector );
+    }
     hog.setSVMDetector( hog_detector );
     // Open the camera.
     video.open(1);
@@ -409,13 +545,24 @@ void test_it( const string & output_file, int video_source, const Size & size )
         if( img.empty() )
             break;
 
-        draw = img.clone();
-
+        // The window is the only sink, so boxes go straight onto the
+        // captured frame; the next read reuses its buffer.
         locations.clear();
-        hog.detectMultiScale( img, locations );
-        draw_locations( draw, locations, trained );
+        if( deadline_ms > 0 )
+        {
+            // Levels that miss the budget are tried first on the next frame.
+            const chrono::steady_clock::time_point deadline = chrono::steady_clock::now()
+                + chrono::duration_cast< chrono::steady_clock::duration >( chrono::duration< double, milli >( deadline_ms ) );
+            pyramid.Detect( hog, img, deadline, detections );
+            for( size_t i = 0 ; i < detections.size() ; ++i )
+                locations.push_back( detections[i].box );
+            groupRectangles( locations, 2, 0.2 ); // detectMultiScale's default grouping
+        }
+        else
+            hog.detectMultiScale( img, locations );
+        draw_locations( img, locations, trained );
 
-        imshow( "Video", draw );
+        imshow( "Video", img );
         key = (char)waitKey( 10 );
         if( 27 == key )
             end_of_process = true;
@@ -424,9 +571,15 @@ void test_it( const string & output_file, int video_source, const Size & size )
 
 int main( int argc, char** argv )
 {
-  bool test_only;
-  int width, height, video_source;
+  bool test_only, luma, flip;
+  int negatives_per_frame;
+  unsigned int seed;
+  int width, height, video_source, thread_count, frames_per_video;
+  double svm_c, svm_p, deadline_ms;
+  std::string storage_name;
+  FeatureStorage storage;
   std::string output_file;
+  std::string manifest_file;
   std::string positive_source_directory;
   std::string negative_source_directory;
 
@@ -441,7 +594,18 @@ int main( int argc, char** argv )
     ("height,h", po::value<int>(&height)->default_value(128), "Specify train window height")
     ("positive,p", po::value<std::string>(&positive_source_directory)->default_value(boost::filesystem::current_path().string<string>()+"/positive"), "Specify positive video files directory")
     ("negative,n", po::value<std::string>(&negative_source_directory)->default_value(boost::filesystem::current_path().string<string>()+"/negative"), "Specify negative video files direcotry")
-    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<string>()+"/feature.data"), "Specify an output file");
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<string>()+"/feature.data"), "Specify an output file")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of loader threads (0 uses every core)")
+    ("frames-per-video", po::value<int>(&frames_per_video)->default_value(0), "Specify evenly spaced frames to sample per video (0 uses every frame)")
+    ("luma", po::value<bool>(&luma)->default_value(false), "Specify whether to load the decoder's luma plane instead of converting BGR frames")
+    ("flip", po::value<bool>(&flip)->default_value(false), "Specify whether to add mirrored positives by permuting their descriptors")
+    ("negatives-per-frame,k", po::value<int>(&negatives_per_frame)->default_value(1), "Specify negative windows sampled from each decoded frame")
+    ("seed", po::value<unsigned int>(&seed)->default_value(1), "Specify the negative window sampling seed")
+    ("manifest,m", po::value<std::string>(&manifest_file), "Specify a dataset manifest from videoindex instead of scanning directories")
+    ("C", po::value<double>(&svm_c)->default_value(0.01), "Specify the SVM soft margin constant")
+    ("p", po::value<double>(&svm_p)->default_value(0.1), "Specify epsilon of the SVR loss")
+    ("deadline", po::value<double>(&deadline_ms)->default_value(0), "Specify a per-frame detection budget in ms while testing (0 scores every level)")
+    ("storage", po::value<std::string>(&storage_name)->default_value("f32"), "Specify how training rows are kept: f32 (OpenCV SVM), f16 or q8 (8-bit, one scale per 36 values)");
 
     po::variables_map vm;
     po::store(po::command_line_parser(argc,argv).options(desc).run(), vm);
@@ -453,6 +617,7 @@ int main( int argc, char** argv )
     }
 
     po::notify(vm);
+    if(!ParseFeatureStorage(storage_name, storage)) throw std::invalid_argument("unknown storage "+storage_name);
   }
   catch(std::exception& e) {
     cerr << "Error: " << e.what() << endl;
@@ -467,36 +632,32 @@ int main( int argc, char** argv )
 
   if(!test_only) {
   vector< Mat > pos_lst;
-  vector< Mat > full_neg_lst;
-  vector< Mat > neg_lst;
-  vector< Mat > gradient_lst;
-  vector< int > labels;
-
-  load_images( positive_source_directory, pos_lst, win_size );
-  labels.assign( pos_lst.size(), +1 );
-  const unsigned int old = (unsigned int)labels.size();
-  load_images( negative_source_directory, full_neg_lst );
-  sample_neg( full_neg_lst, neg_lst, win_size );
-  labels.insert( labels.end(), neg_lst.size(), -1 );
-  CV_Assert( old < labels.size() );
+  DescriptorSink sink( storage );
 
-  cout << "Computing HOG for positive samples..." << endl;
-  compute_hog( pos_lst, gradient_lst, win_size );
-  cout << "Computing HOG for negative samples..." << endl;
-  compute_hog( neg_lst, gradient_lst, win_size );
+  vector< string > pos_videos, neg_videos;
+  vector< int > pos_frame_counts, neg_frame_counts;
+  list_videos( positive_source_directory, manifest_file, +1, pos_videos, pos_frame_counts );
+  list_videos( negative_source_directory, manifest_file, -1, neg_videos, neg_frame_counts );
 
-  cout << "Training..." << endl;
-  train_svm( gradient_lst, labels, output_file );
+  const FrameFormat format = ( luma ? kLumaFrames : kBgrFrames );
+  load_images( pos_videos, pos_frame_counts, pos_lst, win_size, thread_count, frames_per_video, format );
+  if( flip ) set_flip( sink, win_size );
 
+  cout << "Computing HOG for positive samples..." << endl;
+  compute_hog( pos_lst, sink, win_size );
   pos_lst.clear();
-  full_neg_lst.clear();
-  neg_lst.clear();
-  gradient_lst.clear();
-  labels.clear();
+  const size_t old = sink.size();
+  cout << "Sampling HOG for negative samples..." << endl;
+  sample_negatives( neg_videos, neg_frame_counts, sink, win_size, negatives_per_frame, seed, thread_count, frames_per_video, format );
+  CV_Assert( old < sink.size() );
+
+  cout << "Training..." << endl;
+  if( storage == kFloat32Storage ) train_svm( sink.gradient_lst, sink.labels, output_file, svm_c, svm_p );
+  else train_packed_svm( sink.data, output_file, svm_c, svm_p );
   }
 
   cout << "Testing..." << endl;
-  test_it( output_file, video_source, win_size );
+  test_it( output_file, video_source, win_size, deadline_ms );
 
   return 0;
 }
@@ -0,0 +1,161 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  svmupdate.cpp
+ *
+ *    Description:  Incremental detector training warm-started from a previous model
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 14시 51분 37초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <vector>
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "detector_io.h"
+#include "feature_file.h"
+#include "linear_svm.h"
+
+struct CloserToMargin {
+  const std::vector<double> *margins;
+  bool operator()(int a, int b) const { return (*margins)[a]<(*margins)[b]; }
+};
+
+int main(int argc, char** argv) {
+  int retain;
+  std::string model_file;
+  std::string support_file;
+  std::string support_output_file;
+  std::string output_file;
+  std::string loss_name;
+  std::string storage_name;
+  std::vector<std::string> feature_files;
+  LinearSvmParams params;
+  FeatureMatrix data;
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("source,s", po::value< std::vector<std::string> >(&feature_files)->required(), "Specify the feature files with the new rows")
+    ("model,m", po::value<std::string>(&model_file), "Specify the previous detector or OpenCV SVM model to warm start from")
+    ("support", po::value<std::string>(&support_file), "Specify retained support rows from the previous update")
+    ("retain,r", po::value<int>(&retain)->default_value(0), "Specify how many support rows nearest the margin to retain for the next update (0 keeps none)")
+    ("support-output", po::value<std::string>(&support_output_file), "Specify where to write retained support rows (default <output>.sv)")
+    ("loss,l", po::value<std::string>(&loss_name)->default_value("hinge"), "Specify the loss: hinge, squared_hinge or svr")
+    ("C,c", po::value<double>(&params.C)->default_value(0.01), "Specify the soft margin constant")
+    ("p", po::value<double>(&params.p)->default_value(0.1), "Specify epsilon of the svr loss")
+    ("tolerance,e", po::value<double>(&params.tolerance)->default_value(1e-3), "Specify the stopping tolerance")
+    ("iterations,i", po::value<int>(&params.max_iterations)->default_value(1000), "Specify the maximum number of passes")
+    ("storage", po::value<std::string>(&storage_name)->default_value("f32"), "Specify how rows are kept in memory: f32, f16 or q8 (8-bit, one scale per 36 values)")
+    ("output,o", po::value<std::string>(&output_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/detector.data"), "Specify an output file");
+
+    po::positional_options_description p;
+    p.add("source",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(p).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options] features..." << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+    if(!ParseSvmLoss(loss_name, params.loss)) throw std::invalid_argument("unknown loss "+loss_name);
+    if(!ParseFeatureStorage(storage_name, data.storage)) throw std::invalid_argument("unknown storage "+storage_name);
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+  if(support_output_file.empty()) support_output_file=output_file+".sv";
+
+  const std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+
+  for(size_t i=0; i<feature_files.size(); i++) {
+    if(!ReadFeatureFile(feature_files[i], data)) {
+      std::cerr << "Error reading feature file " << feature_files[i] << std::endl;
+      return 1;
+    }
+  }
+  const int new_rows=data.rows;
+  if(!support_file.empty() && !ReadFeatureFile(support_file, data)) {
+    std::cerr << "Error reading support rows " << support_file << std::endl;
+    return 1;
+  }
+  if(data.rows==0) {
+    std::cerr << "Error: no training rows" << std::endl;
+    return 1;
+  }
+
+  std::vector<float> detector;
+  if(!model_file.empty()) {
+    if(!LoadDetector(model_file, detector)) {
+      std::cerr << "Error loading model " << model_file << std::endl;
+      return 1;
+    }
+    if((int)detector.size()!=data.cols+1) {
+      std::cerr << "Error: model has " << detector.size()-1 << " weights but rows have "
+                << data.cols << " features" << std::endl;
+      return 1;
+    }
+  }
+
+  std::clog << (detector.empty() ? "Training from scratch" : "Warm starting from "+model_file)
+            << " on " << new_rows << " new and " << data.rows-new_rows << " retained rows...";
+  std::vector<double> alpha;
+  const int passes=TrainLinearSvm(data, params, detector, &alpha);
+  std::clog << "...[done] " << passes << " passes" << std::endl;
+
+  if(!SaveDetector(output_file, detector)) {
+    std::cerr << "Error writing detector " << output_file << std::endl;
+    return 1;
+  }
+
+  // Keep the support vectors nearest the margin (y*f closest to 1); they
+  // carry the history forward without replaying the full archive next time.
+  // Rows far inside the wrong side are mostly bound vectors and label noise.
+  if(retain>0) {
+    std::vector<double> margins(data.rows);
+    std::vector<float> scratch(data.cols);
+    std::vector<int> support;
+    for(int i=0; i<data.rows; i++) {
+      if(alpha[i]==0.0) continue;
+      const double signed_value=(data.labels[i]>0 ? 1.0 : -1.0)*DecisionValue(detector, data.row(i, scratch.data()), data.cols);
+      margins[i]=std::fabs(signed_value-1.0);
+      support.push_back(i);
+    }
+    CloserToMargin closer;
+    closer.margins=&margins;
+    std::sort(support.begin(), support.end(), closer);
+    if((int)support.size()>retain) support.resize(retain);
+    std::sort(support.begin(), support.end());
+
+    std::ofstream support_output(support_output_file.c_str(), std::ios::out|std::ios::trunc);
+    WriteFeatureRows(support_output, data, support);
+    std::cout << "Retained " << support.size() << " support rows in " << support_output_file << std::endl;
+  }
+
+  const double seconds=std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  std::cout << "Updated detector written to " << output_file << " in " << seconds << "s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  detection_protocol_test.cpp
+ *
+ *    Description:  Checks which passed descriptors SharedFrameBuffer::Map accepts
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 23시 05분 12초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "detection_protocol.h"
+
+namespace {
+
+const size_t kBufferBytes = 1<<16;
+
+int failures = 0;
+
+void Expect(bool condition, const char *what) {
+  if(condition) return;
+  std::fprintf(stderr, "FAILED: %s\n", what);
+  failures++;
+}
+
+// Passes `fd` over a socket pair the way svmclient does and maps what
+// arrives on the other end like svmserver.
+bool SendAndMap(int fd, size_t size) {
+  int sockets[2];
+  if(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets)<0) return false;
+  AttachBuffer attach;
+  attach.buffer_id=1;
+  attach.reserved=0;
+  attach.size=size;
+  bool mapped=false;
+  MessageHeader header;
+  std::vector<char> payload;
+  int received_fd=-1;
+  if(SendMessage(sockets[0], kAttachBufferMessage, &attach, sizeof(attach), fd)
+     && ReceiveMessage(sockets[1], header, payload, &received_fd) && received_fd>=0) {
+    SharedFrameBuffer buffer;
+    mapped=buffer.Map(received_fd, size, false);
+  }
+  close(sockets[0]);
+  close(sockets[1]);
+  return mapped;
+}
+
+int MemoryFile(unsigned int flags, size_t size) {
+  const int fd=memfd_create("detection-protocol-test", MFD_CLOEXEC|flags);
+  if(fd<0 || ftruncate(fd, size)<0) std::abort();
+  return fd;
+}
+
+}
+
+int main() {
+  SharedFrameBuffer created;
+  Expect(created.Create(kBufferBytes), "Create makes a buffer");
+  Expect(SendAndMap(created.fd(), kBufferBytes), "a shrink-sealed memfd is accepted");
+  Expect(!SendAndMap(created.fd(), 2*kBufferBytes), "a size past the end is rejected");
+
+  // Sealable but never sealed: the client could still truncate it.
+  int fd=MemoryFile(MFD_ALLOW_SEALING, kBufferBytes);
+  Expect(!SendAndMap(fd, kBufferBytes), "an unsealed memfd is rejected");
+  close(fd);
+
+  // Not sealable: F_GET_SEALS reports only F_SEAL_SEAL.
+  fd=MemoryFile(0, kBufferBytes);
+  Expect(!SendAndMap(fd, kBufferBytes), "a memfd without sealing is rejected");
+  close(fd);
+
+  // Not shared memory at all: F_GET_SEALS fails with -1.
+  char path[]="/tmp/detection-protocol-testXXXXXX";
+  fd=mkstemp(path);
+  if(fd<0 || ftruncate(fd, kBufferBytes)<0) std::abort();
+  unlink(path);
+  Expect(!SendAndMap(fd, kBufferBytes), "a regular file is rejected");
+  close(fd);
+
+  if(failures) return 1;
+  std::printf("detection_protocol_test passed\n");
+  return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  video_scheduler.cpp
+ *
+ *    Description:  Splits a video dataset into frame segments for parallel ingestion
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 09시 40분 02초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "video_scheduler.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+void ListVideoFiles(const std::string &directory, std::vector<std::string> &videos) {
+  boost::filesystem::path current_dir(directory);
+  if(!boost::filesystem::is_directory(current_dir)) return;
+
+  boost::filesystem::directory_iterator dir_iter(current_dir), eod;
+
+  std::vector<std::string> listed;
+  BOOST_FOREACH(boost::filesystem::path const &file_path, std::make_pair(dir_iter, eod)) {
+    if(!boost::filesystem::is_regular_file(file_path)) continue;
+    listed.push_back(file_path.string<std::string>());
+  }
+  std::sort(listed.begin(), listed.end());
+  videos.insert(videos.end(), listed.begin(), listed.end());
+}
+
+void PlanVideoSegments(const std::vector<std::string> &videos,
+                       int segment_frames,
+                       std::vector<VideoSegment> &segments,
+                       int frames_per_video) {
+  std::vector<int> frame_counts(videos.size(), 0);
+  for(int video_index=0; video_index<(int)videos.size(); video_index++) {
+    cv::VideoCapture video(videos[video_index]);
+    if(video.isOpened()) frame_counts[video_index]=(int)video.get(cv::CAP_PROP_FRAME_COUNT);
+  }
+  PlanVideoSegments(frame_counts, segment_frames, segments, frames_per_video);
+}
+
+void PlanVideoSegments(const std::vector<int> &frame_counts,
+                       int segment_frames,
+                       std::vector<VideoSegment> &segments,
+                       int frames_per_video) {
+  for(int video_index=0; video_index<(int)frame_counts.size(); video_index++) {
+    const int frame_count=frame_counts[video_index];
+
+    VideoSegment segment;
+    segment.video_index=video_index;
+    segment.step=1;
+    if(frame_count<=0) {
+      segment.begin_frame=0;
+      segment.end_frame=-1;
+      segments.push_back(segment);
+      continue;
+    }
+
+    int first_frame=0;
+    int planned_frames=frame_count;
+    if(frames_per_video>0 && frames_per_video<frame_count) {
+      // One frame from the middle of each of frames_per_video equal strata.
+      segment.step=frame_count/frames_per_video;
+      first_frame=segment.step/2;
+      planned_frames=frames_per_video;
+    }
+    // step can be 1 while sampling (frames_per_video<frame_count<2x), so
+    // test the frame budget rather than the step.
+    const bool sampled=(planned_frames!=frame_count);
+    const int frames_per_segment=(segment_frames>0 ? segment_frames : planned_frames);
+
+    for(int planned=0; planned<planned_frames; planned+=frames_per_segment) {
+      segment.begin_frame=first_frame+planned*segment.step;
+      const int count=std::min(frames_per_segment, planned_frames-planned);
+      // A full decode leaves its last segment open-ended: container frame
+      // counts are estimates and may undercount.
+      if(!sampled && planned+count==planned_frames) segment.end_frame=-1;
+      else segment.end_frame=segment.begin_frame+(count-1)*segment.step+1;
+      segments.push_back(segment);
+    }
+  }
+}
+
+int SegmentFrameCount(const VideoSegment &segment) {
+  if(segment.end_frame<0) return -1;
+  const int step=std::max(segment.step, 1);
+  return (segment.end_frame-segment.begin_frame+step-1)/step;
+}
+
+namespace {
+
+// Moves the decoder from frame `position` to just before `target`. A backend
+// that fails one seek is read sequentially from then on.
+bool SkipTo(cv::VideoCapture &video, const std::string &video_path, FrameFormat format,
+            int &position, int target, bool &seekable) {
+  if(seekable && target-position>kMaxGrabDistance) {
+    video.set(cv::CAP_PROP_POS_FRAMES, target);
+    if((int)video.get(cv::CAP_PROP_POS_FRAMES)==target) {
+      position=target;
+      return true;
+    }
+    seekable=false;
+    if(!OpenVideo(video, video_path, format)) return false;
+    position=0;
+  }
+  while(position<target) {
+    if(!video.grab()) return false;
+    position++;
+  }
+  return true;
+}
+
+bool IsFourcc(double fourcc, const char *code) {
+  return (int)fourcc==cv::VideoWriter::fourcc(code[0], code[1], code[2], code[3]);
+}
+
+// Copies out the luma of a decoded frame `height` rows tall (<=0 if the
+// backend does not say). Returns false for layouts that carry no usable
+// luma, e.g. an MJPEG buffer passed through unconverted.
+bool ExtractLuma(cv::Mat &raw, double fourcc, int height, cv::Mat &luma) {
+  if(raw.rows<=1) return false;
+  switch(raw.type()) {
+    case CV_8UC1:
+      if(height<=0 || raw.rows==height) {
+        // Already luma: trade buffers instead of copying. The caller keeps
+        // the decoded one and the next retrieve() lands in the frame's old
+        // buffer, so a frame still in use is never overwritten.
+        cv::swap(raw, luma);
+        return true;
+      }
+      // Planar 4:2:0 (I420, NV12, ...) stacks the chroma planes under the
+      // Y plane; keep only the first `height` rows.
+      if(raw.rows<height) return false;
+      raw.rowRange(0, height).copyTo(luma);
+      return true;
+    case CV_8UC2:
+      // Packed 4:2:2: Y is every other byte, first for YUYV, second for UYVY.
+      cv::extractChannel(raw, luma, IsFourcc(fourcc, "UYVY") ? 1 : 0);
+      return true;
+    case CV_8UC3:
+      cv::cvtColor(raw, luma, cv::COLOR_BGR2GRAY);
+      return true;
+    case CV_8UC4:
+      cv::cvtColor(raw, luma, cv::COLOR_BGRA2GRAY);
+      return true;
+  }
+  return false;
+}
+
+}
+
+bool OpenVideo(cv::VideoCapture &video, const std::string &video_path, FrameFormat format) {
+  if(!video.open(video_path)) return false;
+  if(format==kLumaFrames) video.set(cv::CAP_PROP_CONVERT_RGB, 0);
+  return video.isOpened();
+}
+
+bool ReadFrame(cv::VideoCapture &video, FrameFormat format, cv::Mat &raw, cv::Mat &frame) {
+  if(format==kBgrFrames) return video.read(frame) && !frame.empty();
+
+  if(!video.grab() || !video.retrieve(raw) || raw.empty()) return false;
+  const int height=(int)video.get(cv::CAP_PROP_FRAME_HEIGHT);
+  if(ExtractLuma(raw, video.get(cv::CAP_PROP_FOURCC), height, frame)) return true;
+  // This backend passes through something we cannot read luma from; let it
+  // convert to BGR from now on and take the current frame again.
+  video.set(cv::CAP_PROP_CONVERT_RGB, 1);
+  if(!video.retrieve(raw) || raw.empty()) return false;
+  return ExtractLuma(raw, video.get(cv::CAP_PROP_FOURCC), height, frame);
+}
+
+bool ReadVideoSegment(const std::string &video_path,
+                      const VideoSegment &segment,
+                      const FrameVisitor &visit,
+                      FrameFormat format) {
+  cv::VideoCapture video;
+  if(!OpenVideo(video, video_path, format)) return false;
+
+  const int step=std::max(segment.step, 1);
+  int position=0;
+  bool seekable=true;
+  cv::Mat raw, frame;
+  for(int frame_index=segment.begin_frame;
+      segment.end_frame<0 || frame_index<segment.end_frame;
+      frame_index+=step) {
+    if(!SkipTo(video, video_path, format, position, frame_index, seekable)) break;
+    if(!ReadFrame(video, format, raw, frame)) break;
+    position++;
+    visit(frame, frame_index);
+  }
+  return true;
+}
@@ -0,0 +1,91 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  video_scheduler.h
+ *
+ *    Description:  Splits a video dataset into frame segments for parallel ingestion
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 09시 40분 02초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_VIDEO_SCHEDULER_H_
+#define VIDEOTRAINER_VIDEO_SCHEDULER_H_
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+#include <boost/function.hpp>
+
+const int kDefaultSegmentFrames = 300;
+// Beyond this many frames a seek (which restarts decoding at the nearest
+// keyframe) is cheaper than grabbing forward frame by frame.
+const int kMaxGrabDistance = 48;
+
+struct VideoSegment {
+  int video_index;
+  int begin_frame;
+  int end_frame; // -1 reads until the end of the video
+  int step;      // decode every step-th frame starting at begin_frame
+};
+
+// kLumaFrames hands out single-channel 8-bit frames for the HOG path, which
+// only looks at intensity anyway.
+enum FrameFormat {
+  kBgrFrames,
+  kLumaFrames
+};
+
+typedef boost::function<void (const cv::Mat &frame, int frame_index)> FrameVisitor;
+
+// Lists the regular files of a directory in lexicographic order, so every
+// run and every tool sees the same video order.
+void ListVideoFiles(const std::string &directory, std::vector<std::string> &videos);
+
+// Cuts each video into runs of at most segment_frames decoded frames using
+// CAP_PROP_FRAME_COUNT. With frames_per_video>0 only that many evenly spaced
+// frames are planned per video. Videos that cannot report a length stay whole
+// and are decoded in full.
+void PlanVideoSegments(const std::vector<std::string> &videos,
+                       int segment_frames,
+                       std::vector<VideoSegment> &segments,
+                       int frames_per_video=0);
+
+// Same as above with frame counts already known (e.g. from a manifest), so
+// no video has to be opened. A count <=0 marks an unknown length.
+void PlanVideoSegments(const std::vector<int> &frame_counts,
+                       int segment_frames,
+                       std::vector<VideoSegment> &segments,
+                       int frames_per_video=0);
+
+// Number of frames a segment will decode, or -1 if it is open-ended.
+int SegmentFrameCount(const VideoSegment &segment);
+
+// Opens a video for the given format. For kLumaFrames the backend is asked
+// to skip its RGB conversion (CAP_PROP_CONVERT_RGB) so the decoder's own
+// YUV frame comes through where it supports that.
+bool OpenVideo(cv::VideoCapture &video, const std::string &video_path, FrameFormat format);
+
+// Decodes the next frame into `frame`. For kLumaFrames the Y plane is taken
+// straight from a packed YUV frame; backends that only give BGR (or hand
+// over still-encoded buffers) are converted once into `frame`, whose buffer
+// is reused across calls. `raw` is scratch space owned by the caller.
+bool ReadFrame(cv::VideoCapture &video, FrameFormat format, cv::Mat &raw, cv::Mat &frame);
+
+// Decodes the frames of one segment in order. Gaps longer than
+// kMaxGrabDistance are crossed with CAP_PROP_POS_FRAMES seeks, shorter ones
+// with grab() so skipped frames are never converted.
+// Returns false if the video could not be opened.
+bool ReadVideoSegment(const std::string &video_path,
+                      const VideoSegment &segment,
+                      const FrameVisitor &visit,
+                      FrameFormat format=kBgrFrames);
+
+#endif
@@ -0,0 +1,120 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  videoindex.cpp
+ *
+ *    Description:  Builds or refreshes the dataset manifest of a training corpus
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 11시 31분 20초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include <map>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "dataset_manifest.h"
+#include "video_scheduler.h"
+#include "work_stealing.h"
+
+int main ( int argc, const char * argv[] ) {
+  int thread_count;
+  std::string manifest_file;
+  std::string positive_source_directory;
+  std::string negative_source_directory;
+
+  try {
+    namespace po=boost::program_options;
+    po::options_description desc("Options");
+    desc.add_options()
+    ("help,h", "Print help messages")
+    ("positive,p", po::value<std::string>(&positive_source_directory)->default_value(boost::filesystem::current_path().string<std::string>()+"/positive"), "Specify positive video files directory")
+    ("negative,n", po::value<std::string>(&negative_source_directory)->default_value(boost::filesystem::current_path().string<std::string>()+"/negative"), "Specify negative video files direcotry")
+    ("output,o", po::value<std::string>(&manifest_file)->default_value(boost::filesystem::current_path().string<std::string>()+"/dataset.manifest"), "Specify the manifest file to create or refresh")
+    ("threads,j", po::value<int>(&thread_count)->default_value(0), "Specify number of probing threads (0 uses every core)");
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).run(), vm);
+
+    if (vm.count("help")) {
+      std::cout << "Usage: " << argv[0] << " [options]" << std::endl;
+      std::cout << desc;
+      return 0;
+    }
+
+    po::notify(vm);
+  }
+  catch(std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+  catch(...) {
+    std::cerr << "Exception of unknown type!" << std::endl;
+    return 1;
+  }
+
+  // Entries of files that kept their size and mtime are carried over
+  // without being reopened or rehashed.
+  std::map<std::string, ManifestEntry> previous;
+  {
+    std::vector<ManifestEntry> entries;
+    if(LoadManifest(manifest_file, entries)) {
+      for(size_t i=0; i<entries.size(); i++) previous[entries[i].path]=entries[i];
+    }
+  }
+
+  std::vector<std::string> videos;
+  std::vector<int> labels;
+  ListVideoFiles(positive_source_directory, videos);
+  labels.assign(videos.size(), +1);
+  ListVideoFiles(negative_source_directory, videos);
+  labels.resize(videos.size(), -1);
+
+  std::vector<ManifestEntry> entries(videos.size());
+  std::vector<char> indexed(videos.size(), 0);
+  int reused=0;
+  std::vector<int> pending;
+  for(int i=0; i<(int)videos.size(); i++) {
+    std::map<std::string, ManifestEntry>::const_iterator iter=previous.find(videos[i]);
+    if(iter!=previous.end() && iter->second.label==labels[i] && IsUnchanged(iter->second)) {
+      entries[i]=iter->second;
+      indexed[i]=1;
+      reused++;
+    } else pending.push_back(i);
+  }
+
+  WorkStealingPool pool(thread_count);
+  pool.Run((int)pending.size(), [&](int task, int) {
+    const int i=pending[task];
+    indexed[i]=ProbeVideo(videos[i], labels[i], entries[i]);
+  });
+
+  std::vector<ManifestEntry> manifest;
+  long long total_frames=0;
+  for(int i=0; i<(int)videos.size(); i++) {
+    if(!indexed[i]) {
+      std::cerr << "Skipping unreadable video " << videos[i] << std::endl;
+      continue;
+    }
+    manifest.push_back(entries[i]);
+    if(entries[i].frame_count>0) total_frames+=entries[i].frame_count;
+  }
+
+  if(!SaveManifest(manifest_file, manifest)) {
+    std::cerr << "Error writing manifest " << manifest_file << std::endl;
+    return 1;
+  }
+  std::cout << "Indexed " << manifest.size() << " videos (" << reused << " unchanged, "
+            << pending.size() << " probed), " << total_frames << " frames." << std::endl;
+
+  return 0;
+}
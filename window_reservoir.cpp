@@ -0,0 +1,74 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  window_reservoir.cpp
+ *
+ *    Description:  Fixed-size stratified reservoir of training windows
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 22시 15분 31초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "window_reservoir.h"
+
+#include <algorithm>
+
+WindowReservoir::WindowReservoir(int capacity, int videos, unsigned int seed)
+  : remaining_capacity_(std::max(capacity, 0)), remaining_videos_(std::max(videos, 1)),
+    video_index_(-1), random_(seed), offered_(0), admitted_(0) {}
+
+void WindowReservoir::BeginVideo(int video_index, int levels) {
+  video_index_=video_index;
+  levels=std::max(levels, 1);
+  const int video_quota=remaining_capacity_/std::max(remaining_videos_, 1);
+  current_.assign(levels, Stratum());
+  for(int level=0; level<levels; level++) {
+    // The remainder goes to the finest levels, which see the most windows.
+    current_[level].quota=video_quota/levels+(level<video_quota%levels ? 1 : 0);
+    current_[level].seen=0;
+  }
+}
+
+WindowSample *WindowReservoir::Admit(int frame_index, int level, const cv::Rect &box) {
+  if(level<0 || level>=(int)current_.size()) return 0;
+  Stratum &stratum=current_[level];
+  offered_++;
+  const long long seen=stratum.seen++;
+  if(stratum.quota<=0) return 0;
+
+  WindowSample *slot;
+  if((int)stratum.samples.size()<stratum.quota) {
+    stratum.samples.push_back(WindowSample());
+    slot=&stratum.samples.back();
+  } else {
+    const long long pick=std::uniform_int_distribution<long long>(0, seen)(random_);
+    if(pick>=stratum.quota) return 0;
+    slot=&stratum.samples[pick];
+  }
+  admitted_++;
+  slot->video_index=video_index_;
+  slot->frame_index=frame_index;
+  slot->level=level;
+  slot->box=box;
+  return slot;
+}
+
+void WindowReservoir::EndVideo() {
+  for(size_t level=0; level<current_.size(); level++) {
+    std::vector<WindowSample> &samples=current_[level].samples;
+    remaining_capacity_-=(int)samples.size();
+    kept_.insert(kept_.end(), samples.begin(), samples.end());
+  }
+  current_.clear();
+  remaining_videos_=std::max(remaining_videos_-1, 1);
+}
+
+void WindowReservoir::Collect(std::vector<WindowSample> &samples) const {
+  samples.insert(samples.end(), kept_.begin(), kept_.end());
+}
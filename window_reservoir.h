@@ -0,0 +1,80 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  window_reservoir.h
+ *
+ *    Description:  Fixed-size stratified reservoir of training windows
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 22시 15분 31초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_WINDOW_RESERVOIR_H_
+#define VIDEOTRAINER_WINDOW_RESERVOIR_H_
+
+#include <random>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// A window that made it into the reservoir. `box` is in the coordinates of
+// the original frame; `pixels` is the window resized to the training size,
+// filled in by the caller on admission and kept until HOG runs at the end.
+struct WindowSample {
+  int video_index;
+  int frame_index;
+  int level;
+  cv::Rect box;
+  cv::Mat pixels;
+};
+
+// Keeps at most `capacity` windows of one label while candidates stream
+// past, so the training set and the HOG work stay the same size however
+// much footage is fed in. The capacity is split evenly over the videos
+// still to come and a video's share evenly over its pyramid levels; each
+// (video, level) stratum is a uniform reservoir (Algorithm R) over the
+// candidates it saw. Share a stratum cannot fill passes on to later videos.
+class WindowReservoir {
+ public:
+  WindowReservoir(int capacity, int videos, unsigned int seed);
+
+  void BeginVideo(int video_index, int levels);
+
+  // Draws whether the next candidate of `level` is kept. Returns the slot
+  // to fill -- possibly evicting an earlier window -- or 0 to skip it, so
+  // pixels are only copied for admitted windows. The slot stays valid
+  // until the next call.
+  WindowSample *Admit(int frame_index, int level, const cv::Rect &box);
+
+  void EndVideo();
+
+  // Admitted windows, in stratum order.
+  void Collect(std::vector<WindowSample> &samples) const;
+
+  long long offered() const { return offered_; }
+  long long admitted() const { return admitted_; }
+
+ private:
+  struct Stratum {
+    int quota;
+    long long seen;
+    std::vector<WindowSample> samples;
+  };
+
+  int remaining_capacity_;
+  int remaining_videos_;
+  int video_index_;
+  std::vector<Stratum> current_;
+  std::vector<WindowSample> kept_;
+  std::mt19937 random_;
+  long long offered_;
+  long long admitted_;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  window_sampler.cpp
+ *
+ *    Description:  Samples several HOG windows per decoded frame in one pass
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 58분 10초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "window_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::mt19937 FrameRandom(unsigned int seed, int video_index, int frame_index) {
+  std::seed_seq sequence{seed, (unsigned int)video_index, (unsigned int)frame_index};
+  return std::mt19937(sequence);
+}
+
+void PickWindows(const cv::Size &frame_size, const cv::Size &window_size, const cv::Size &stride,
+                 int count, std::mt19937 &random, std::vector<cv::Point> &locations) {
+  locations.clear();
+  if(count<=0 || stride.width<=0 || stride.height<=0) return;
+  if(frame_size.width<window_size.width || frame_size.height<window_size.height) return;
+
+  const int grid_x=(frame_size.width-window_size.width)/stride.width+1;
+  const int grid_y=(frame_size.height-window_size.height)/stride.height+1;
+  count=std::min(count, grid_x*grid_y);
+
+  // Tiles keep roughly the aspect ratio of the grid.
+  int tiles_x=std::max(1, std::min(grid_x, (int)std::ceil(std::sqrt((double)count*grid_x/grid_y))));
+  int tiles_y=std::max(1, std::min(grid_y, (count+tiles_x-1)/tiles_x));
+  while(tiles_x*tiles_y<count) {
+    if(tiles_x<grid_x) tiles_x++;
+    else tiles_y++;
+  }
+
+  std::vector<int> tiles(tiles_x*tiles_y);
+  for(size_t i=0; i<tiles.size(); i++) tiles[i]=(int)i;
+  std::shuffle(tiles.begin(), tiles.end(), random);
+  for(int i=0; i<count; i++) {
+    const int tile_x=tiles[i]%tiles_x;
+    const int tile_y=tiles[i]/tiles_x;
+    // Tile bounds on the grid; every tile holds at least one grid point.
+    const int x0=tile_x*grid_x/tiles_x, x1=(tile_x+1)*grid_x/tiles_x;
+    const int y0=tile_y*grid_y/tiles_y, y1=(tile_y+1)*grid_y/tiles_y;
+    std::uniform_int_distribution<int> pick_x(x0, std::max(x0, x1-1));
+    std::uniform_int_distribution<int> pick_y(y0, std::max(y0, y1-1));
+    locations.push_back(cv::Point(pick_x(random)*stride.width, pick_y(random)*stride.height));
+  }
+}
+
+void ComputeWindowDescriptors(const cv::HOGDescriptor &hog, const cv::Mat &frame,
+                              const std::vector<cv::Point> &locations,
+                              std::vector<float> &descriptors, cv::Mat &gray) {
+  descriptors.clear();
+  if(locations.empty()) return;
+  const cv::Mat *input=&frame;
+  if(frame.channels()!=1) {
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    input=&gray;
+  }
+  hog.compute(*input, descriptors, hog.blockStride, cv::Size(0, 0), locations);
+}
@@ -0,0 +1,44 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  window_sampler.h
+ *
+ *    Description:  Samples several HOG windows per decoded frame in one pass
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 18시 58분 10초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_WINDOW_SAMPLER_H_
+#define VIDEOTRAINER_WINDOW_SAMPLER_H_
+
+#include <random>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// Generator for one frame, seeded from (seed, video, frame) only, so the
+// windows a frame yields do not depend on which thread decoded it.
+std::mt19937 FrameRandom(unsigned int seed, int video_index, int frame_index);
+
+// Picks up to `count` distinct window origins on the `stride` grid of a
+// frame. The grid is cut into about `count` tiles and each chosen tile
+// contributes one origin, so windows spread over the whole frame.
+void PickWindows(const cv::Size &frame_size, const cv::Size &window_size, const cv::Size &stride,
+                 int count, std::mt19937 &random, std::vector<cv::Point> &locations);
+
+// Descriptors of every window in `locations`, back to back, from a single
+// HOGDescriptor::compute call, so the frame is converted to gray and its
+// gradients computed once rather than once per crop. `gray` is scratch
+// reused across frames; single-channel frames are used as they are.
+void ComputeWindowDescriptors(const cv::HOGDescriptor &hog, const cv::Mat &frame,
+                              const std::vector<cv::Point> &locations,
+                              std::vector<float> &descriptors, cv::Mat &gray);
+
+#endif
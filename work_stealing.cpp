@@ -0,0 +1,92 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  work_stealing.cpp
+ *
+ *    Description:  Work-stealing task pool with in-order result emission
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 09시 12분 31초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#include "work_stealing.h"
+
+#include <algorithm>
+#include <deque>
+#include <thread>
+
+namespace {
+
+struct WorkQueue {
+  std::deque<int> tasks;
+  std::mutex mutex;
+};
+
+bool PopOwn(WorkQueue &queue, int &task) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if(queue.tasks.empty()) return false;
+  task=queue.tasks.back();
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool Steal(WorkQueue &queue, int &task) {
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if(queue.tasks.empty()) return false;
+  task=queue.tasks.front();
+  queue.tasks.pop_front();
+  return true;
+}
+
+void WorkerLoop(std::vector<WorkQueue> &queues, int worker, const WorkStealingPool::Task &run) {
+  const int queue_count=(int)queues.size();
+  int task;
+  for(;;) {
+    if(PopOwn(queues[worker], task)) {
+      run(task, worker);
+      continue;
+    }
+    // Tasks are never re-queued, so one full sweep without a steal means the
+    // pool is drained.
+    bool stolen=false;
+    for(int offset=1; offset<queue_count && !stolen; offset++) {
+      stolen=Steal(queues[(worker+offset)%queue_count], task);
+    }
+    if(!stolen) return;
+    run(task, worker);
+  }
+}
+
+}
+
+WorkStealingPool::WorkStealingPool(int thread_count) : thread_count_(thread_count) {
+  if(thread_count_<=0) thread_count_=(int)std::thread::hardware_concurrency();
+  if(thread_count_<=0) thread_count_=1;
+}
+
+void WorkStealingPool::Run(int task_count, const Task &task) {
+  if(task_count<=0) return;
+  const int worker_count=std::min(thread_count_, task_count);
+  if(worker_count==1) {
+    for(int i=0; i<task_count; i++) task(i, 0);
+    return;
+  }
+
+  // Deal tasks out round-robin, pushed in reverse so the owner pops its
+  // lowest task first while thieves take from the far end.
+  std::vector<WorkQueue> queues(worker_count);
+  for(int i=task_count-1; i>=0; i--) queues[i%worker_count].tasks.push_back(i);
+
+  std::vector<std::thread> workers;
+  for(int worker=1; worker<worker_count; worker++) {
+    workers.push_back(std::thread(WorkerLoop, std::ref(queues), worker, std::cref(task)));
+  }
+  WorkerLoop(queues, 0, task);
+  for(size_t i=0; i<workers.size(); i++) workers[i].join();
+}
@@ -0,0 +1,97 @@
+/*
+ * =====================================================================================
+ *
+ *       Filename:  work_stealing.h
+ *
+ *    Description:  Work-stealing task pool with in-order result emission
+ *
+ *        Version:  1.0
+ *        Created:  2026/10/19 09시 12분 31초
+ *       Revision:  none
+ *       Compiler:  gcc
+ *
+ *         Author:  Il Jae Lee (iljae), iljae@umich.edu
+ *   Organization:  University of Michigan
+ *
+ * =====================================================================================
+ */
+#ifndef VIDEOTRAINER_WORK_STEALING_H_
+#define VIDEOTRAINER_WORK_STEALING_H_
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <boost/function.hpp>
+
+// Runs tasks [0, task_count) on a fixed set of workers. Worker w owns a
+// deque seeded round-robin with tasks w, w+T, w+2T, ...; it pops its lowest
+// task and, once it runs dry, steals the highest task of another worker.
+// Tasks therefore start roughly in index order, which keeps the reorder
+// backlog of an OrderedEmitter small.
+class WorkStealingPool {
+ public:
+  typedef boost::function<void (int task, int worker)> Task;
+
+  // thread_count<=0 uses std::thread::hardware_concurrency().
+  explicit WorkStealingPool(int thread_count=0);
+
+  int thread_count() const { return thread_count_; }
+
+  // Blocks until every task has run.
+  void Run(int task_count, const Task &task);
+
+ private:
+  int thread_count_;
+};
+
+// Collects per-task results and hands them to `emit` strictly in task order,
+// as soon as the completed prefix grows, so output stays deterministic no
+// matter which worker finishes first.
+//
+// With a `window`, Wait(task) blocks a worker until `task` is fewer than
+// `window` tasks ahead of the next one to emit, which caps the results held
+// back. Under WorkStealingPool the next task is always running or first in
+// its owner's deque, so waiting cannot deadlock.
+template <typename Result>
+class OrderedEmitter {
+ public:
+  typedef boost::function<void (int task, Result &result)> Emit;
+
+  explicit OrderedEmitter(const Emit &emit, int window=0) : emit_(emit), next_(0), window_(window) {}
+
+  void Wait(int task) {
+    if(window_<=0) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(task-next_>=window_) advanced_.wait(lock);
+  }
+
+  void Complete(int task, Result &result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(task!=next_) {
+      Result &pending=pending_[task];
+      std::swap(pending, result);
+      return;
+    }
+    emit_(task, result);
+    ++next_;
+    typename std::map<int, Result>::iterator iter;
+    while((iter=pending_.find(next_))!=pending_.end()) {
+      emit_(next_, iter->second);
+      pending_.erase(iter);
+      ++next_;
+    }
+    if(window_>0) advanced_.notify_all();
+  }
+
+ private:
+  Emit emit_;
+  int next_;
+  int window_;
+  std::map<int, Result> pending_;
+  std::mutex mutex_;
+  std::condition_variable advanced_;
+};
+
+#endif